@@ -0,0 +1,197 @@
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "AssetArchive.h"
+#include "TextureCache.h"
+
+AssetArchive::~AssetArchive()
+{
+	close();
+}
+
+/**
+*   @brief   Opens an archive.
+*   @details Every entry is checked to lie within the file before it
+			 is indexed, so a truncated archive is rejected rather
+			 than read out of bounds later.
+*   @return  True if the archive is ready to use.
+*/
+bool AssetArchive::open(const std::string& file_name)
+{
+	close();
+	if (!map(file_name))
+	{
+		return false;
+	}
+
+	ArchiveFormat::Header header;
+	if (length < sizeof(header))
+	{
+		close();
+		return false;
+	}
+
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, ArchiveFormat::MAGIC, 4) != 0 ||
+		header.version != ArchiveFormat::VERSION ||
+		header.entry_count > (length - sizeof(header)) / sizeof(ArchiveFormat::Entry))
+	{
+		close();
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header.entry_count; i++)
+	{
+		ArchiveFormat::Entry entry;
+		std::memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+		entry.name[ArchiveFormat::NAME_LENGTH - 1] = '\0';
+
+		auto bytes = uint64_t(entry.width) * entry.height * 4;
+		if (entry.offset > length || bytes > length - entry.offset)
+		{
+			close();
+			return false;
+		}
+
+		Image image;
+		image.width = static_cast<int>(entry.width);
+		image.height = static_cast<int>(entry.height);
+		image.pixels = data + entry.offset;
+		images[TextureCache::normalise(entry.name)] = image;
+	}
+
+	return true;
+}
+
+void AssetArchive::close()
+{
+	images.clear();
+	unmap();
+}
+
+bool AssetArchive::isOpen() const
+{
+	return data != nullptr;
+}
+
+const AssetArchive::Image* AssetArchive::find(const std::string& file_name) const
+{
+	auto found = images.find(TextureCache::normalise(file_name));
+	return found == images.end() ? nullptr : &found->second;
+}
+
+size_t AssetArchive::size() const
+{
+	return images.size();
+}
+
+#ifdef _WIN32
+
+bool AssetArchive::map(const std::string& file_name)
+{
+	auto handle = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	file = handle;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(handle, &file_size) || file_size.QuadPart == 0)
+	{
+		unmap();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		unmap();
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!data)
+	{
+		unmap();
+		return false;
+	}
+
+	length = static_cast<size_t>(file_size.QuadPart);
+	return true;
+}
+
+void AssetArchive::unmap()
+{
+	if (data)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mapping)
+	{
+		CloseHandle(mapping);
+	}
+	if (file)
+	{
+		CloseHandle(file);
+	}
+
+	data = nullptr;
+	length = 0;
+	mapping = nullptr;
+	file = nullptr;
+}
+
+#else
+
+bool AssetArchive::map(const std::string& file_name)
+{
+	int descriptor = ::open(file_name.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(descriptor, &info) != 0 || info.st_size == 0)
+	{
+		::close(descriptor);
+		return false;
+	}
+
+	// the mapping keeps the file alive, so the descriptor can go
+	auto view = mmap(nullptr, static_cast<size_t>(info.st_size),
+		PROT_READ, MAP_PRIVATE, descriptor, 0);
+	::close(descriptor);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(view);
+	length = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void AssetArchive::unmap()
+{
+	if (data)
+	{
+		munmap(const_cast<uint8_t*>(data), length);
+	}
+
+	data = nullptr;
+	length = 0;
+}
+
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/**
+*  The layout of an asset archive, as written by the ArchivePacker tool.
+*  A header is followed by a table of entries, then by the pixel data
+*  of each image as tightly packed 8 bit RGBA. Every payload starts on
+*  an ALIGNMENT byte boundary. Values are stored little endian.
+*/
+namespace ArchiveFormat
+{
+	const char MAGIC[4] = { 'B', 'P', 'A', 'K' };
+	const uint32_t VERSION = 1;
+	const uint32_t NAME_LENGTH = 112;
+	const uint32_t ALIGNMENT = 64;
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entry_count;
+		uint32_t reserved;
+	};
+
+	struct Entry
+	{
+		char name[NAME_LENGTH]; /**< Path of the source image, nul terminated. */
+		uint64_t offset;        /**< Start of the pixels, from the start of the file. */
+		uint32_t width;
+		uint32_t height;
+	};
+
+	static_assert(sizeof(Header) == 16, "archive header must be 16 bytes");
+	static_assert(sizeof(Entry) == 128, "archive entry must be 128 bytes");
+}
+
+/**
+*  A read only, memory mapped asset archive.
+*  Opening the archive maps the whole file and builds an index of its
+*  images; nothing is read or decoded until the pixels are touched.
+*  The pixels stay valid until the archive is closed, so they can be
+*  handed to the renderer without copying.
+*/
+class AssetArchive
+{
+public:
+
+	/**
+	*  An image held in the archive.
+	*/
+	struct Image
+	{
+		int width = 0;
+		int height = 0;
+		const uint8_t* pixels = nullptr; /**< RGBA pixels, inside the mapping. */
+	};
+
+	AssetArchive() = default;
+
+	/**
+	*  Destructor. Unmaps the archive.
+	*/
+	~AssetArchive();
+
+	AssetArchive(const AssetArchive&) = delete;
+	AssetArchive& operator=(const AssetArchive&) = delete;
+
+	/**
+	*  Maps an archive and reads its index.
+	*  @param [in] file_name The file path to the archive.
+	*  @return true if the archive was opened and is valid.
+	*/
+	bool open(const std::string& file_name);
+
+	/**
+	*  Unmaps the archive. Any pixels obtained from it become invalid.
+	*/
+	void close();
+
+	/**
+	*  Checks whether an archive is open.
+	*  @return true if open succeeded.
+	*/
+	bool isOpen() const;
+
+	/**
+	*  Finds an image by the path of its source file.
+	*  The path is normalised as the texture cache does, so the same
+	*  path used to load the loose file finds it in the archive.
+	*  @param [in] file_name The file path of the original image.
+	*  @return the image, or nullptr if the archive does not hold it.
+	*/
+	const Image* find(const std::string& file_name) const;
+
+	/**
+	*  Returns the number of images in the archive.
+	*  @return the image count.
+	*/
+	size_t size() const;
+
+private:
+	bool map(const std::string& file_name);
+	void unmap();
+
+	const uint8_t* data = nullptr;
+	size_t length = 0;
+	void* file = nullptr;
+	void* mapping = nullptr;
+	std::unordered_map<std::string, Image> images;
+};
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <memory>
+
+#include "AssetLoader.h"
+
+AssetLoader::AssetLoader(unsigned worker_count)
+{
+	if (worker_count == 0)
+	{
+		// leave a core for the main thread, which uploads the results
+		auto cores = std::thread::hardware_concurrency();
+		worker_count = std::max(1u, cores > 1 ? cores - 1 : 1u);
+	}
+
+	for (unsigned i = 0; i < worker_count; i++)
+	{
+		workers.emplace_back(&AssetLoader::work, this);
+	}
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		jobs.clear();
+	}
+
+	wake.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+std::future<Png::Image> AssetLoader::decode(const std::string& file_name)
+{
+	// std::function needs a copyable target, so the promise is shared
+	auto promise = std::make_shared<std::promise<Png::Image>>();
+	auto result = promise->get_future();
+
+	submit([promise, file_name]()
+	{
+		Png::Image image;
+		if (!Png::load(file_name, image))
+		{
+			image = Png::Image();
+		}
+		promise->set_value(std::move(image));
+	});
+
+	return result;
+}
+
+void AssetLoader::load(const std::string& file_name, Callback on_loaded)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		outstanding++;
+	}
+
+	submit([this, file_name, on_loaded]()
+	{
+		Finished done;
+		done.file_name = file_name;
+		done.on_loaded = on_loaded;
+		if (!Png::load(file_name, done.image))
+		{
+			done.image = Png::Image();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		finished.push_back(std::move(done));
+	});
+}
+
+/**
+*   @brief   Delivers finished loads.
+*   @details Callbacks run without the lock held, so they are free
+			 to queue further loads.
+*   @return  The number of loads still outstanding.
+*/
+size_t AssetLoader::update(size_t max_callbacks)
+{
+	for (size_t i = 0; i < max_callbacks; i++)
+	{
+		Finished done;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (finished.empty())
+			{
+				break;
+			}
+
+			done = std::move(finished.front());
+			finished.pop_front();
+		}
+
+		done.on_loaded(done.file_name, done.image);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		outstanding--;
+	}
+
+	return pending();
+}
+
+size_t AssetLoader::pending() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return outstanding;
+}
+
+void AssetLoader::submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+
+	wake.notify_one();
+}
+
+void AssetLoader::work()
+{
+	for (;;)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping)
+			{
+				return;
+			}
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Png.h"
+
+/**
+*  Loads and decodes images on a pool of worker threads.
+*  Files are read and decoded off the main thread. Results are either
+*  collected through a future, or handed to a callback that runs on the
+*  thread calling update, which is where the renderer expects textures
+*  to be created. A failed load produces an image with no pixels.
+*/
+class AssetLoader
+{
+public:
+
+	/**
+	*  Called on the main thread once an image has been decoded.
+	*  @param [in] file_name The file that was loaded.
+	*  @param [in] image The decoded image, empty if loading failed.
+	*  The callback may move its pixels away to keep them.
+	*/
+	using Callback = std::function<void(const std::string& file_name, Png::Image& image)>;
+
+	/**
+	*  Constructor. Starts the worker threads.
+	*  @param [in] worker_count The number of threads, 0 picks one per spare core.
+	*/
+	explicit AssetLoader(unsigned worker_count = 0);
+
+	/**
+	*  Destructor. Abandons queued work and joins the workers.
+	*/
+	~AssetLoader();
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	/**
+	*  Decodes an image on a worker thread.
+	*  @param [in] file_name The file path to the image.
+	*  @return a future holding the decoded image.
+	*/
+	std::future<Png::Image> decode(const std::string& file_name);
+
+	/**
+	*  Decodes an image on a worker thread and queues a callback.
+	*  The callback runs during a later call to update.
+	*  @param [in] file_name The file path to the image.
+	*  @param [in] on_loaded The function to call with the decoded image.
+	*/
+	void load(const std::string& file_name, Callback on_loaded);
+
+	/**
+	*  Runs the callbacks of finished loads on the calling thread.
+	*  @param [in] max_callbacks The most callbacks to run, limiting the
+	*  time spent per frame.
+	*  @return the number of loads that have not yet been delivered.
+	*/
+	size_t update(size_t max_callbacks);
+
+	/**
+	*  Returns the number of loads that have not yet been delivered.
+	*  @return the outstanding load count.
+	*/
+	size_t pending() const;
+
+private:
+	struct Finished
+	{
+		std::string file_name;
+		Png::Image image;
+		Callback on_loaded;
+	};
+
+	void submit(std::function<void()> job);
+	void work();
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<std::function<void()>> jobs;
+	std::deque<Finished> finished;
+	std::vector<std::thread> workers;
+	size_t outstanding = 0;
+	bool stopping = false;
+};
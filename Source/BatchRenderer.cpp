@@ -0,0 +1,42 @@
+#include "BatchRenderer.h"
+
+/**
+*   @brief   Draws a batch, through BatchRenderer where possible.
+*   @details The fallback is the loop the game used to run itself,
+			 one renderSprite call per instance.
+*   @return  void
+*/
+void renderSprites(ASGE::Renderer* renderer, ASGE::Sprite& sprite,
+	const SpriteInstance* instances, size_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	auto batch_renderer = dynamic_cast<BatchRenderer*>(renderer);
+	if (batch_renderer)
+	{
+		batch_renderer->renderSprites(sprite, instances, count);
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const auto& instance = instances[i];
+		sprite.xPos(instance.x);
+		sprite.yPos(instance.y);
+		sprite.width(instance.width);
+		sprite.height(instance.height);
+		sprite.colour(ASGE::Colour(instance.tint));
+		sprite.opacity(instance.tint[3]);
+
+		auto source = sprite.srcRect();
+		for (int j = 0; j < 4; j++)
+		{
+			source[j] = instance.src_rect[j];
+		}
+
+		renderer->renderSprite(sprite, instance.z_order);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+/**
+*  One sprite in a batch, drawn with the batch's texture.
+*/
+struct SpriteInstance
+{
+	float x = 0;                     /**< Left edge on screen. */
+	float y = 0;                     /**< Top edge on screen. */
+	float width = 0;                 /**< Width on screen, before the batch's scale. */
+	float height = 0;                /**< Height on screen, before the batch's scale. */
+	float src_rect[4]{ 0,0,0,0 };    /**< Texels to draw: x, y, width, height. */
+	float tint[4]{ 1,1,1,1 };        /**< Red, green, blue and opacity. */
+	float z_order = 0;               /**< Depth used by the sorting modes. */
+};
+
+/**
+*  Implemented by renderers that can draw many sprites in one call.
+*  ASGE renderers draw one sprite per virtual renderSprite call, and
+*  check their state for each. Renderers written for this game can
+*  also implement this interface, and take a whole span of instances
+*  sharing a texture at once, as one instanced draw or one CPU loop.
+*  Use the renderSprites function below, which falls back to
+*  renderSprite for renderers that do not implement it.
+*/
+class BatchRenderer
+{
+public:
+	virtual ~BatchRenderer() = default;
+
+	/**
+	*  Draws a span of instances that share a texture.
+	*  The texture, rotation, scale and flip flags are taken from
+	*  the sprite; everything else from each instance.
+	*  @param [in] sprite The sprite holding the texture.
+	*  @param [in] instances The instances, drawn in order.
+	*  @param [in] count The number of instances.
+	*/
+	virtual void renderSprites(const ASGE::Sprite& sprite,
+		const SpriteInstance* instances, size_t count) = 0;
+};
+
+/**
+*  Draws a span of instances that share a texture.
+*  Renderers that implement BatchRenderer take the span in a single
+*  call. For others, the sprite is updated and drawn once per
+*  instance, so its position, size, source rectangle, colour and
+*  opacity are left as the last instance's.
+*  @param [in] renderer The renderer to draw with.
+*  @param [in] sprite The sprite holding the texture.
+*  @param [in] instances The instances, drawn in order.
+*  @param [in] count The number of instances.
+*/
+void renderSprites(ASGE::Renderer* renderer, ASGE::Sprite& sprite,
+	const SpriteInstance* instances, size_t count);
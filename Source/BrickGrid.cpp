@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cassert>
+#include "BrickGrid.h"
+
+/**
+*   @brief   Sizes the grid to cover an area.
+*   @details Allocates the cells and the per brick bookkeeping up
+			 front so that inserting and removing bricks during
+			 play never has to grow the index arrays.
+*   @return  void
+*/
+void BrickGrid::reset(float width, float height, float cell_size, int max_bricks)
+{
+	this->cell_size = std::max(cell_size, 1.0f);
+	columns = std::max(1, static_cast<int>(width / this->cell_size) + 1);
+	rows = std::max(1, static_cast<int>(height / this->cell_size) + 1);
+	live_bricks = 0;
+
+	cells.assign(columns * rows, std::vector<int>());
+	entries.assign(max_bricks * MAX_CELLS_PER_BRICK, CellEntry());
+	query_stamps.assign(max_bricks, 0);
+	query_stamp = 0;
+}
+
+/**
+*   @brief   Registers a brick with the grid.
+*   @details The brick is appended to each covered cell and the
+			 slot it was placed in is remembered for removal.
+*   @return  void
+*/
+void BrickGrid::insert(int brick, const rect& bounds)
+{
+	assert(brick >= 0 && brick < static_cast<int>(query_stamps.size()));
+	remove(brick);
+
+	int x0, y0, x1, y1;
+	cellRange(bounds, x0, y0, x1, y1);
+	assert((x1 - x0 + 1) * (y1 - y0 + 1) <= MAX_CELLS_PER_BRICK);
+
+	auto entry = &entries[brick * MAX_CELLS_PER_BRICK];
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			auto cell = y * columns + x;
+			entry->cell = cell;
+			entry->slot = static_cast<int>(cells[cell].size());
+			cells[cell].push_back(brick);
+			entry++;
+		}
+	}
+
+	live_bricks++;
+}
+
+/**
+*   @brief   Removes a brick from the grid.
+*   @details Each cell the brick lives in has its last entry moved
+			 into the brick's slot, and that entry's bookkeeping is
+			 patched. No cell is ever searched.
+*   @return  void
+*/
+void BrickGrid::remove(int brick)
+{
+	auto entry = &entries[brick * MAX_CELLS_PER_BRICK];
+	if (entry->cell < 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < MAX_CELLS_PER_BRICK && entry[i].cell >= 0; i++)
+	{
+		auto& cell = cells[entry[i].cell];
+		auto moved = cell.back();
+		cell[entry[i].slot] = moved;
+		cell.pop_back();
+
+		if (moved != brick)
+		{
+			auto moved_entry = &entries[moved * MAX_CELLS_PER_BRICK];
+			for (int j = 0; j < MAX_CELLS_PER_BRICK; j++)
+			{
+				if (moved_entry[j].cell == entry[i].cell)
+				{
+					moved_entry[j].slot = entry[i].slot;
+					break;
+				}
+			}
+		}
+
+		entry[i] = CellEntry();
+	}
+
+	live_bricks--;
+}
+
+/**
+*   @brief   Collects the bricks near an area.
+*   @details Uses a stamp per brick rather than a set to skip
+			 bricks that have already been reported by another
+			 cell, keeping the query free of allocations once the
+			 results vector has grown.
+*   @return  void
+*/
+void BrickGrid::query(const rect& area, std::vector<int>& results)
+{
+	results.clear();
+
+	if (++query_stamp == 0)
+	{
+		std::fill(query_stamps.begin(), query_stamps.end(), 0);
+		query_stamp = 1;
+	}
+
+	int x0, y0, x1, y1;
+	cellRange(area, x0, y0, x1, y1);
+
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			for (auto brick : cells[y * columns + x])
+			{
+				if (query_stamps[brick] != query_stamp)
+				{
+					query_stamps[brick] = query_stamp;
+					results.push_back(brick);
+				}
+			}
+		}
+	}
+}
+
+int BrickGrid::size() const
+{
+	return live_bricks;
+}
+
+/**
+*   @brief   Converts an area into a range of cells.
+*   @details The range is inclusive and clamped to the grid, so
+			 areas partially or fully outside of it are safe.
+*   @return  void
+*/
+void BrickGrid::cellRange(const rect& area, int& x0, int& y0, int& x1, int& y1) const
+{
+	auto toCell = [this](float value, int count)
+	{
+		auto cell = static_cast<int>(value / cell_size);
+		return std::min(std::max(cell, 0), count - 1);
+	};
+
+	x0 = toCell(area.x, columns);
+	y0 = toCell(area.y, rows);
+	x1 = toCell(area.x + area.length, columns);
+	y1 = toCell(area.y + area.height, rows);
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include "Rect.h"
+
+/**
+*  A uniform grid spatial index for bricks.
+*  The play area is divided into equally sized cells and every
+*  live brick is registered with each cell its bounding box covers.
+*  Queries only visit the cells a box touches, so the cost of a
+*  collision check depends on the local brick density rather than
+*  the total number of bricks in the level. Bricks are identified
+*  by the index the game uses to store them.
+*/
+class BrickGrid
+{
+public:
+
+	/**
+	*  Default constructor.
+	*/
+	BrickGrid() = default;
+
+	/**
+	*  Sizes the grid to cover an area.
+	*  Any previously inserted bricks are discarded. The cell size
+	*  should be at least as large as the biggest brick, so that
+	*  a brick never covers more than four cells.
+	*  @param [in] width The width of the area in pixels.
+	*  @param [in] height The height of the area in pixels.
+	*  @param [in] cell_size The width and height of a cell in pixels.
+	*  @param [in] max_bricks The largest brick index that will be stored.
+	*/
+	void  reset(float width, float height, float cell_size, int max_bricks);
+
+	/**
+	*  Registers a brick with every cell its bounding box covers.
+	*  Parts of the box outside the grid are clamped to the edges.
+	*  @param [in] brick The index of the brick.
+	*  @param [in] bounds The brick's bounding box.
+	*/
+	void  insert(int brick, const rect& bounds);
+
+	/**
+	*  Removes a brick from the grid in constant time.
+	*  Removing a brick that is not in the grid does nothing.
+	*  @param [in] brick The index of the brick.
+	*/
+	void  remove(int brick);
+
+	/**
+	*  Collects the bricks whose cells overlap an area.
+	*  Each brick is reported once, even if it covers several of the
+	*  visited cells. The results are candidates only, the caller
+	*  still needs to test the actual bounding boxes.
+	*  @param [in] area The area to search, typically a swept box.
+	*  @param [out] results Cleared and filled with brick indices.
+	*/
+	void  query(const rect& area, std::vector<int>& results);
+
+	/**
+	*  Returns the number of bricks currently in the grid.
+	*  @return the number of live bricks.
+	*/
+	int   size() const;
+
+private:
+	/**
+	*  Where a brick is stored. Allows a brick to be
+	*  swapped out of its cells without searching them.
+	*/
+	struct CellEntry
+	{
+		int cell = -1;
+		int slot = -1;
+	};
+
+	static constexpr int MAX_CELLS_PER_BRICK = 4;
+
+	void  cellRange(const rect& area, int& x0, int& y0, int& x1, int& y1) const;
+
+	float cell_size = 1;
+	int   columns = 0;
+	int   rows = 0;
+	int   live_bricks = 0;
+
+	std::vector<std::vector<int>> cells;
+	std::vector<CellEntry> entries;
+	std::vector<unsigned int> query_stamps;
+	unsigned int query_stamp = 0;
+};
@@ -0,0 +1,81 @@
+#include <algorithm>
+
+#include "DirtyRegions.h"
+
+namespace
+{
+	rect merge(const rect& a, const rect& b)
+	{
+		rect bounds;
+		bounds.x = std::min(a.x, b.x);
+		bounds.y = std::min(a.y, b.y);
+		bounds.length = std::max(a.x + a.length, b.x + b.length) - bounds.x;
+		bounds.height = std::max(a.y + a.height, b.y + b.height) - bounds.y;
+		return bounds;
+	}
+}
+
+DirtyRegions::DirtyRegions(size_t max) : max_regions(std::max<size_t>(max, 1))
+{
+
+}
+
+/**
+*   @brief   Adds a region.
+*   @details The region absorbs every region it overlaps. Growing
+			 may make it overlap others, so this repeats until it is
+			 clear of them all.
+*   @return  void
+*/
+void DirtyRegions::add(const rect& region)
+{
+	if (region.length <= 0 || region.height <= 0)
+	{
+		return;
+	}
+
+	auto grown = region;
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (size_t i = 0; i < dirty.size(); i++)
+		{
+			if (grown.isInside(dirty[i]))
+			{
+				grown = merge(grown, dirty[i]);
+				dirty[i] = dirty.back();
+				dirty.pop_back();
+				merged = true;
+				break;
+			}
+		}
+	}
+
+	dirty.push_back(grown);
+	if (dirty.size() > max_regions)
+	{
+		auto bounds = dirty[0];
+		for (const auto& other : dirty)
+		{
+			bounds = merge(bounds, other);
+		}
+
+		dirty.assign(1, bounds);
+	}
+}
+
+void DirtyRegions::clear()
+{
+	dirty.clear();
+}
+
+bool DirtyRegions::empty() const
+{
+	return dirty.empty();
+}
+
+const std::vector<rect>& DirtyRegions::regions() const
+{
+	return dirty;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Rect.h"
+
+/**
+*  A set of screen regions that need redrawing.
+*  Overlapping regions are merged as they are added, so no area is
+*  redrawn twice. Past a limit every region is merged into one, as
+*  a few large redraws cost less than many small ones.
+*/
+class DirtyRegions
+{
+public:
+
+	/**
+	*  Constructor.
+	*  @param [in] max_regions The most regions kept apart.
+	*/
+	explicit DirtyRegions(size_t max_regions = 8);
+
+	/**
+	*  Marks a region as needing a redraw.
+	*  @param [in] region The area that changed.
+	*/
+	void add(const rect& region);
+
+	/**
+	*  Forgets every region, once they have been redrawn.
+	*/
+	void clear();
+
+	/**
+	*  Checks whether anything needs redrawing.
+	*  @return true if no region has been added since the last clear.
+	*/
+	bool empty() const;
+
+	/**
+	*  Returns the regions, none of which overlap.
+	*  @return the regions to redraw.
+	*/
+	const std::vector<rect>& regions() const;
+
+private:
+	size_t max_regions = 8;
+	std::vector<rect> dirty;
+};
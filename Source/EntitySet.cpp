@@ -0,0 +1,64 @@
+#include "EntitySet.h"
+
+int EntitySet::add(const rect& entity_bounds, int entity_sprite)
+{
+	bounds.push_back(entity_bounds);
+	vel_x.push_back(0);
+	vel_y.push_back(0);
+	visible.push_back(1);
+	sprite.push_back(entity_sprite);
+
+	return static_cast<int>(size()) - 1;
+}
+
+void EntitySet::clear()
+{
+	bounds.clear();
+	vel_x.clear();
+	vel_y.clear();
+	visible.clear();
+	sprite.clear();
+}
+
+void EntitySet::reserve(size_t count)
+{
+	bounds.reserve(count);
+	vel_x.reserve(count);
+	vel_y.reserve(count);
+	visible.reserve(count);
+	sprite.reserve(count);
+}
+
+size_t EntitySet::size() const
+{
+	return visible.size();
+}
+
+rect EntitySet::boundingBox(size_t idx) const
+{
+	return bounds[idx];
+}
+
+void EntitySet::integrate(float dt_sec)
+{
+	integrate(dt_sec, 0, size());
+}
+
+/**
+*   @brief   Moves the visible entities in a range.
+*   @details Written as plain loops over the arrays so the
+			 compiler is free to vectorise them.
+*   @return  void
+*/
+void EntitySet::integrate(float dt_sec, size_t begin, size_t end)
+{
+	auto x = bounds.x.data();
+	auto y = bounds.y.data();
+
+	for (size_t i = begin; i < end; i++)
+	{
+		auto scale = visible[i] ? dt_sec : 0.0f;
+		x[i] += vel_x[i] * scale;
+		y[i] += vel_y[i] * scale;
+	}
+}
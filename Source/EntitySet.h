@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RectBatch.h"
+
+/**
+*  A set of entities stored as contiguous component arrays.
+*  Rather than each entity owning a heap allocated component, every
+*  component lives in its own array indexed by entity, so systems
+*  such as movement, collision and rendering walk memory linearly.
+*  The bounds double as the positions and sizes and can be handed
+*  straight to the batched overlap tests. Sprites are referenced by
+*  a handle, allowing many entities to share one loaded sprite.
+*  @see RectArray
+*/
+class EntitySet
+{
+public:
+
+	/**
+	*  Default constructor.
+	*/
+	EntitySet() = default;
+
+	/**
+	*  Adds an entity with all of its components.
+	*  The entity starts stationary and visible.
+	*  @param [in] bounds The position and size of the entity.
+	*  @param [in] sprite The handle of the sprite used to draw it.
+	*  @return the index of the new entity.
+	*/
+	int   add(const rect& bounds, int sprite);
+
+	/**
+	*  Removes every entity.
+	*/
+	void  clear();
+
+	/**
+	*  Reserves space in every component array.
+	*  @param [in] count The number of entities expected.
+	*/
+	void  reserve(size_t count);
+
+	/**
+	*  Returns the number of entities, visible or not.
+	*  @return the number of entities.
+	*/
+	size_t size() const;
+
+	/**
+	*  Returns an entity's bounding box.
+	*  @param [in] idx The index of the entity.
+	*  @return the entity's position and size.
+	*/
+	rect  boundingBox(size_t idx) const;
+
+	/**
+	*  Moves every visible entity by its velocity.
+	*  @param [in] dt_sec The elapsed time in seconds.
+	*/
+	void  integrate(float dt_sec);
+
+	/**
+	*  Moves the visible entities in a range by their velocity.
+	*  Ranges that do not overlap can be moved on different threads.
+	*  @param [in] dt_sec The elapsed time in seconds.
+	*  @param [in] begin The first entity to move.
+	*  @param [in] end One past the last entity to move.
+	*/
+	void  integrate(float dt_sec, size_t begin, size_t end);
+
+	RectArray bounds;             /**< Positions and sizes. */
+	std::vector<float> vel_x;     /**< Velocity on the x axis in pixels per second. */
+	std::vector<float> vel_y;     /**< Velocity on the y axis in pixels per second. */
+	std::vector<uint8_t> visible; /**< Non-zero when the entity is active and drawn. */
+	std::vector<int> sprite;      /**< The handle of the sprite used for drawing. */
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+*  A bounded queue of events, pushed from any number of threads and
+*  drained by one, without locks.
+*  Each slot carries a sequence number that tells a pusher when the
+*  slot is free and the reader when it has been filled, so pushers
+*  only contend on claiming a slot and never wait for the reader.
+*  Storage is fixed, so pushing never allocates; when the queue is
+*  full the event is dropped and counted instead.
+*/
+template <typename T, size_t CAPACITY>
+class EventQueue
+{
+	static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0,
+		"event queue capacity must be a power of two");
+
+public:
+	EventQueue()
+	{
+		for (size_t i = 0; i < CAPACITY; i++)
+		{
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	EventQueue(const EventQueue&) = delete;
+	EventQueue& operator=(const EventQueue&) = delete;
+
+	/**
+	*  Adds an event. Safe to call from any thread.
+	*  @param [in] event The event.
+	*  @return false if the queue was full and the event was dropped.
+	*/
+	bool push(const T& event)
+	{
+		auto position = tail.load(std::memory_order_relaxed);
+		while (true)
+		{
+			auto& slot = slots[position & MASK];
+			auto sequence = slot.sequence.load(std::memory_order_acquire);
+			auto lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (lag == 0)
+			{
+				if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					slot.event = event;
+					slot.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (lag < 0)
+			{
+				dropped_events.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+			{
+				// another pusher claimed the slot first
+				position = tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	*  Takes the oldest event. Only the reading thread may call this.
+	*  @param [out] event Set to the event, if there was one.
+	*  @return false if the queue was empty.
+	*/
+	bool pop(T& event)
+	{
+		auto& slot = slots[head & MASK];
+		if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+		{
+			return false;
+		}
+
+		event = slot.event;
+		slot.sequence.store(head + CAPACITY, std::memory_order_release);
+		head++;
+		return true;
+	}
+
+	/**
+	*  Returns the number of events dropped because the queue was full.
+	*  @return the dropped event count.
+	*/
+	uint64_t dropped() const
+	{
+		return dropped_events.load(std::memory_order_relaxed);
+	}
+
+private:
+	static const size_t MASK = CAPACITY - 1;
+
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		T event;
+	};
+
+	Slot slots[CAPACITY];
+	std::atomic<size_t> tail{ 0 };
+	size_t head = 0;
+	std::atomic<uint64_t> dropped_events{ 0 };
+};
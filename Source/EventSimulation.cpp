@@ -0,0 +1,427 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "EventSimulation.h"
+
+namespace
+{
+	// how far ahead, in bricks, a single grid query searches
+	constexpr float SCAN_BRICKS = 4;
+}
+
+EventSimulation::EventSimulation(float width, float height, unsigned int seed) :
+	width(width), height(height), random(seed)
+{
+
+}
+
+void EventSimulation::setBall(const rect& bounds, const vector2& direction, float speed)
+{
+	ball = bounds;
+	ball_direction = direction;
+	ball_speed = speed;
+
+	if (grid_built)
+	{
+		predictBall();
+	}
+}
+
+void EventSimulation::setPaddle(const rect& bounds, float velocity)
+{
+	paddle = bounds;
+	setPaddleVelocity(velocity);
+}
+
+void EventSimulation::setPaddleVelocity(float velocity)
+{
+	paddle_velocity = velocity;
+
+	if (grid_built)
+	{
+		predictPaddle();
+	}
+}
+
+void EventSimulation::setLives(int lives)
+{
+	lives_left = lives;
+}
+
+void EventSimulation::setTickLength(double seconds)
+{
+	tick_length = seconds;
+}
+
+void EventSimulation::onBrickDestroyed(BrickHandler handler)
+{
+	brick_handler = handler;
+}
+
+void EventSimulation::onRespawn(RespawnHandler handler)
+{
+	respawn_handler = handler;
+}
+
+void EventSimulation::addBrick(int id, const rect& bounds)
+{
+	bricks.push_back(bounds);
+	brick_ids.push_back(id);
+	brick_alive.push_back(true);
+	brick_size = std::max(brick_size, std::max(bounds.length, bounds.height));
+	bricks_left++;
+}
+
+/**
+*   @brief   Advances the simulation.
+*   @details The first call builds the brick grid and makes the
+			 initial predictions. Events that were invalidated by
+			 an earlier impact are popped and ignored.
+*   @return  void
+*/
+void EventSimulation::advance(double seconds)
+{
+	if (!grid_built)
+	{
+		grid.reset(width, height, brick_size, static_cast<int>(bricks.size()));
+		for (size_t i = 0; i < bricks.size(); i++)
+		{
+			grid.insert(static_cast<int>(i), bricks[i]);
+		}
+
+		grid_built = true;
+		predictBall();
+		predictPaddle();
+	}
+
+	auto target = now + seconds;
+	while (!finished() && !events.empty() && events.top().time <= target)
+	{
+		auto event = events.top();
+		events.pop();
+
+		if (!isValid(event))
+		{
+			continue;
+		}
+
+		moveTo(event.time);
+		events_processed++;
+
+		switch (event.type)
+		{
+		case EventType::WALL:
+		case EventType::SCAN:
+			reflect(ball_direction, event.normal);
+			predictBall();
+			break;
+
+		case EventType::FLOOR:
+			lives_left--;
+			respawn();
+			predictBall();
+			break;
+
+		case EventType::BRICK:
+			reflect(ball_direction, event.normal);
+			brick_alive[event.brick] = false;
+			grid.remove(event.brick);
+			destroyed.push_back(brick_ids[event.brick]);
+			score_total += 1000;
+			bricks_left--;
+			if (brick_handler)
+			{
+				brick_handler(brick_ids[event.brick], now);
+			}
+			predictBall();
+			break;
+
+		case EventType::PADDLE:
+			// send the ball away from the face that was hit, the paddle
+			// is moving so a plain reflection is not always enough
+			if (event.normal.x != 0)
+			{
+				ball_direction.x = std::abs(ball_direction.x) * event.normal.x;
+
+				// a paddle chasing the ball faster than it travels would
+				// keep hitting it, so lift the ball on top instead
+				auto separation = ball_direction.x * ball_speed - paddle_velocity;
+				if (separation * event.normal.x <= 0)
+				{
+					ball.y = paddle.y - ball.height;
+					ball_direction.y = -std::abs(ball_direction.y);
+				}
+			}
+			if (event.normal.y != 0)
+			{
+				ball_direction.y = std::abs(ball_direction.y) * event.normal.y;
+			}
+			predictBall();
+			break;
+
+		case EventType::PADDLE_WALL:
+			paddle_velocity *= -1;
+			predictPaddle();
+			break;
+		}
+	}
+
+	if (!finished())
+	{
+		moveTo(target);
+	}
+}
+
+bool EventSimulation::finished() const
+{
+	return lives_left <= 0 || bricks_left <= 0;
+}
+
+double EventSimulation::time() const
+{
+	return now;
+}
+
+int EventSimulation::score() const
+{
+	return score_total;
+}
+
+int EventSimulation::lives() const
+{
+	return lives_left;
+}
+
+size_t EventSimulation::eventsProcessed() const
+{
+	return events_processed;
+}
+
+const rect& EventSimulation::ballBounds() const
+{
+	return ball;
+}
+
+const vector2& EventSimulation::ballDirection() const
+{
+	return ball_direction;
+}
+
+const rect& EventSimulation::paddleBounds() const
+{
+	return paddle;
+}
+
+float EventSimulation::paddleVelocity() const
+{
+	return paddle_velocity;
+}
+
+const std::vector<int>& EventSimulation::destroyedBricks() const
+{
+	return destroyed;
+}
+
+/**
+*   @brief   Moves everything to a point in time.
+*   @details Valid because nothing changes direction between
+			 two consecutive events.
+*   @return  void
+*/
+void EventSimulation::moveTo(double target_time)
+{
+	auto dt = static_cast<float>(target_time - now);
+	ball.x += ball_direction.x * ball_speed * dt;
+	ball.y += ball_direction.y * ball_speed * dt;
+	paddle.x += paddle_velocity * dt;
+	now = target_time;
+}
+
+/**
+*   @brief   Respawns the ball after it is lost.
+*   @details Mirrors BreakoutGame::respawn, using the simulation's
+			 own generator so runs are reproducible from the seed,
+			 unless a respawn handler has been set.
+*   @return  void
+*/
+void EventSimulation::respawn()
+{
+	if (respawn_handler)
+	{
+		respawn_handler(ball, ball_direction);
+		return;
+	}
+
+	ball_direction.x = static_cast<float>((random() % 10 + 1) - 5);
+	ball_direction.y = -10;
+	ball_direction.normalise();
+
+	ball.x = (width - ball.length) / 2;
+	ball.y = height - 80;
+}
+
+/**
+*   @brief   Predicts the ball's next impacts.
+*   @details Invalidates all previous ball predictions. The walls
+			 and the floor are found analytically, bricks are only
+			 searched a few bricks ahead at a time; if none are found
+			 a SCAN event continues the search from further along.
+*   @return  void
+*/
+void EventSimulation::predictBall()
+{
+	ball_generation++;
+
+	if (ball_speed <= 0 || finished())
+	{
+		return;
+	}
+
+	auto velocity = ball_direction * ball_speed;
+
+	// long enough to cross the whole play area several times
+	auto horizon = (width + height) * 4 / ball_speed;
+
+	rect walls;
+	walls.length = width;
+	walls.height = std::numeric_limits<float>::max();
+
+	auto boundary = std::numeric_limits<float>::max();
+	auto wall = sweepBounds(ball, velocity * horizon, walls);
+	if (wall.hit)
+	{
+		boundary = wall.time * horizon;
+		schedule(boundary, EventType::WALL, -1, wall.normal);
+	}
+
+	if (velocity.y > 0)
+	{
+		auto floor_time = std::max(0.0f, (height - (ball.y + ball.height)) / velocity.y);
+		boundary = std::min(boundary, floor_time);
+
+		// nothing is hit below the floor, so the ball can carry on
+		// until the end of the tick
+		double lost_time = floor_time;
+		if (tick_length > 0)
+		{
+			lost_time = std::ceil((now + floor_time) / tick_length) * tick_length - now;
+		}
+		schedule(lost_time, EventType::FLOOR, -1, vector2(0, 0));
+	}
+
+	auto scan_time = std::min(boundary, SCAN_BRICKS * brick_size / ball_speed);
+	auto delta = velocity * scan_time;
+
+	rect swept_box;
+	swept_box.x = std::min(ball.x, ball.x + delta.x);
+	swept_box.y = std::min(ball.y, ball.y + delta.y);
+	swept_box.length = ball.length + std::abs(delta.x);
+	swept_box.height = ball.height + std::abs(delta.y);
+	grid.query(swept_box, candidates);
+
+	SweepHit first;
+	int first_brick = -1;
+	for (auto i : candidates)
+	{
+		auto impact = sweepRect(ball, delta, bricks[i]);
+		if (impact.hit && (first_brick < 0 || impact.time < first.time ||
+			(impact.time == first.time && i < first_brick)))
+		{
+			first = impact;
+			first_brick = i;
+		}
+	}
+
+	if (first_brick >= 0)
+	{
+		schedule(first.time * scan_time, EventType::BRICK, first_brick, first.normal);
+	}
+	else if (scan_time < boundary)
+	{
+		schedule(scan_time, EventType::SCAN, -1, vector2(0, 0));
+	}
+
+	predictBallPaddle();
+}
+
+/**
+*   @brief   Predicts when the paddle reaches a wall.
+*   @details Invalidates all previous paddle predictions, including
+			 ball and paddle impacts which depend on both.
+*   @return  void
+*/
+void EventSimulation::predictPaddle()
+{
+	paddle_generation++;
+
+	if (paddle_velocity > 0)
+	{
+		auto time = (width - (paddle.x + paddle.length)) / paddle_velocity;
+		schedule(std::max(time, 0.0f), EventType::PADDLE_WALL, -1, vector2(0, 0));
+	}
+	else if (paddle_velocity < 0)
+	{
+		auto time = -paddle.x / paddle_velocity;
+		schedule(std::max(time, 0.0f), EventType::PADDLE_WALL, -1, vector2(0, 0));
+	}
+
+	predictBallPaddle();
+}
+
+/**
+*   @brief   Predicts when the ball hits the paddle.
+*   @details Sweeps in the paddle's frame of reference using the
+			 relative velocity, which holds until either of them
+			 changes direction.
+*   @return  void
+*/
+void EventSimulation::predictBallPaddle()
+{
+	if (finished())
+	{
+		return;
+	}
+
+	vector2 relative(ball_direction.x * ball_speed - paddle_velocity,
+		ball_direction.y * ball_speed);
+
+	auto horizon = (width + height) * 4 / std::max(ball_speed, 1.0f);
+	auto impact = sweepRect(ball, relative * horizon, paddle);
+	if (impact.hit)
+	{
+		schedule(impact.time * horizon, EventType::PADDLE, -1, impact.normal);
+	}
+}
+
+void EventSimulation::schedule(double delay, EventType type, int brick, const vector2& normal)
+{
+	Event event;
+	event.time = now + delay;
+	event.type = type;
+	event.brick = brick;
+	event.normal = normal;
+	event.ball_generation = ball_generation;
+	event.paddle_generation = paddle_generation;
+	events.push(event);
+}
+
+/**
+*   @brief   Checks whether a prediction still holds.
+*   @details Ball impacts depend on the ball's motion, paddle wall
+			 impacts on the paddle's and ball and paddle impacts
+			 on both.
+*   @return  True if the event should be processed.
+*/
+bool EventSimulation::isValid(const Event& event) const
+{
+	switch (event.type)
+	{
+	case EventType::PADDLE_WALL:
+		return event.paddle_generation == paddle_generation;
+	case EventType::PADDLE:
+		return event.paddle_generation == paddle_generation &&
+			event.ball_generation == ball_generation;
+	default:
+		return event.ball_generation == ball_generation;
+	}
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "BrickGrid.h"
+#include "Rect.h"
+#include "Sweep.h"
+#include "Vector2.h"
+
+/**
+*  An analytic, event driven simulation of the ball and paddle.
+*  Between impacts everything moves in straight lines, so rather
+*  than integrating every frame the simulation predicts the time
+*  of the next impact against the walls, the floor, the paddle and
+*  the bricks, keeps them in a priority queue and jumps straight
+*  to the earliest one. The cost of simulating a session therefore
+*  grows with the number of bounces, not the number of frames.
+*  Predictions are invalidated lazily: every event remembers the
+*  generation of the ball and paddle motion it was predicted from
+*  and is discarded if either has changed by the time it is popped.
+*  Used for headless fast-forwarding; gems are not simulated.
+*/
+class EventSimulation
+{
+public:
+	using BrickHandler = std::function<void(int id, double time)>;
+	using RespawnHandler = std::function<void(rect& bounds, vector2& direction)>;
+
+	/**
+	*  Constructor.
+	*  @param [in] width The width of the play area in pixels.
+	*  @param [in] height The height of the play area in pixels.
+	*  @param [in] seed Seeds the respawn direction generator.
+	*/
+	EventSimulation(float width, float height, unsigned int seed);
+
+	/**
+	*  Places the ball.
+	*  @param [in] bounds The ball's bounding box.
+	*  @param [in] direction The direction of travel, normalised.
+	*  @param [in] speed The speed in pixels per second.
+	*/
+	void setBall(const rect& bounds, const vector2& direction, float speed);
+
+	/**
+	*  Places the paddle.
+	*  The paddle reverses when it reaches a wall, as it does in game.
+	*  @param [in] bounds The paddle's bounding box.
+	*  @param [in] velocity The horizontal velocity in pixels per second.
+	*/
+	void setPaddle(const rect& bounds, float velocity);
+
+	/**
+	*  Changes the paddle's velocity at the current simulation time.
+	*  Used to feed player or bot input into the simulation.
+	*  @param [in] velocity The horizontal velocity in pixels per second.
+	*/
+	void setPaddleVelocity(float velocity);
+
+	/**
+	*  Sets the lives available before the simulation finishes.
+	*  @param [in] lives The number of lives left.
+	*/
+	void setLives(int lives);
+
+	/**
+	*  Matches the game's fixed tick. The game only checks for a lost
+	*  ball at the end of each tick, so the ball is lost at the end of
+	*  the tick it falls out in rather than as it falls out. Ticks are
+	*  counted from the start of the simulation. Defaults to 0, where
+	*  the ball is lost straight away.
+	*  @param [in] seconds The length of a tick.
+	*/
+	void setTickLength(double seconds);
+
+	/**
+	*  Sets a function called as each brick is destroyed, with its id
+	*  and the simulation time.
+	*  @param [in] handler The function to call.
+	*/
+	void onBrickDestroyed(BrickHandler handler);
+
+	/**
+	*  Sets a function that respawns the ball after it is lost, in
+	*  place of the simulation's own, so the game can respawn it from
+	*  its own random numbers.
+	*  @param [in] handler The function, which sets the ball's bounds
+	*  and normalised direction.
+	*/
+	void onRespawn(RespawnHandler handler);
+
+	/**
+	*  Adds a brick to the simulation.
+	*  All bricks should be added before the first call to advance.
+	*  @param [in] id An id used to report the brick when destroyed.
+	*  @param [in] bounds The brick's bounding box.
+	*/
+	void addBrick(int id, const rect& bounds);
+
+	/**
+	*  Advances the simulation.
+	*  Processes every event up to the requested time and then moves
+	*  the ball and paddle to it. Stops early once the simulation
+	*  has finished.
+	*  @param [in] seconds How far to advance from the current time.
+	*/
+	void advance(double seconds);
+
+	/**
+	*  Checks whether the session is over.
+	*  @return true when all bricks are gone or no lives are left.
+	*/
+	bool finished() const;
+
+	double time() const;                   /**< The current simulation time in seconds. */
+	int    score() const;                  /**< Points scored by destroying bricks. */
+	int    lives() const;                  /**< Lives left. */
+	size_t eventsProcessed() const;        /**< Number of valid events handled. */
+	const  rect& ballBounds() const;       /**< The ball's current bounding box. */
+	const  vector2& ballDirection() const; /**< The ball's current direction. */
+	const  rect& paddleBounds() const;     /**< The paddle's current bounding box. */
+	float  paddleVelocity() const;         /**< The paddle's current velocity. */
+
+	/**
+	*  Returns the ids of destroyed bricks in the order they were hit.
+	*  @return the destroyed brick ids.
+	*/
+	const std::vector<int>& destroyedBricks() const;
+
+private:
+	enum class EventType
+	{
+		WALL,        /**< The ball hits a side wall or the ceiling. */
+		FLOOR,       /**< The ball falls out of the bottom. */
+		PADDLE,      /**< The ball hits the paddle. */
+		BRICK,       /**< The ball hits a brick. */
+		SCAN,        /**< The ball leaves the area searched for bricks. */
+		PADDLE_WALL  /**< The paddle reaches a side wall. */
+	};
+
+	struct Event
+	{
+		double       time = 0;
+		EventType    type = EventType::SCAN;
+		int          brick = -1;
+		vector2      normal = { 0,0 };
+		unsigned int ball_generation = 0;
+		unsigned int paddle_generation = 0;
+
+		bool operator>(const Event& rhs) const { return time > rhs.time; }
+	};
+
+	void moveTo(double target_time);
+	void respawn();
+	void predictBall();
+	void predictPaddle();
+	void predictBallPaddle();
+	void schedule(double delay, EventType type, int brick, const vector2& normal);
+	bool isValid(const Event& event) const;
+
+	float width = 0;
+	float height = 0;
+	float brick_size = 0;
+	double now = 0;
+	double tick_length = 0;
+	BrickHandler brick_handler;
+	RespawnHandler respawn_handler;
+
+	rect    ball;
+	vector2 ball_direction = { 0,-1 };
+	float   ball_speed = 0;
+	rect    paddle;
+	float   paddle_velocity = 0;
+
+	std::vector<rect> bricks;
+	std::vector<int>  brick_ids;
+	std::vector<bool> brick_alive;
+	std::vector<int>  destroyed;
+	std::vector<int>  candidates;
+	BrickGrid grid;
+	bool grid_built = false;
+	int  bricks_left = 0;
+
+	int    score_total = 0;
+	int    lives_left = 3;
+	size_t events_processed = 0;
+
+	unsigned int ball_generation = 0;
+	unsigned int paddle_generation = 0;
+	std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+	std::minstd_rand random;
+};
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+
+#include "FrameStats.h"
+
+namespace
+{
+	/**
+	*  Spreads a time over the kept frames.
+	*  The times are reordered in place. Percentiles are by nearest
+	*  rank, so each is a time a frame actually took.
+	*/
+	FrameStats::Spread spread(float* times, size_t count)
+	{
+		FrameStats::Spread result;
+		if (count == 0)
+		{
+			return result;
+		}
+
+		double sum = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			sum += times[i];
+		}
+		result.mean = static_cast<float>(sum / count);
+
+		auto rank = [times, count](double percent)
+		{
+			auto index = static_cast<size_t>(std::ceil(percent * count)) - 1;
+			std::nth_element(times, times + index, times + count);
+			return times[index];
+		};
+		result.p50 = rank(0.50);
+		result.p95 = rank(0.95);
+		result.p99 = rank(0.99);
+		result.max = *std::max_element(times, times + count);
+		return result;
+	}
+}
+
+void FrameStats::setBudget(double ms)
+{
+	budget_ms = static_cast<float>(ms);
+}
+
+void FrameStats::add(const Sample& sample)
+{
+	samples[count % CAPACITY] = sample;
+	count++;
+	if (sample.frame_ms > budget_ms)
+	{
+		total_over_budget++;
+	}
+}
+
+size_t FrameStats::size() const
+{
+	return count < CAPACITY ? count : CAPACITY;
+}
+
+/**
+*   @brief   Summarises the kept frames.
+*   @details The histogram's buckets are half the budget wide, so a
+			 frame on budget falls in the second bucket and the last
+			 holds frames over three and a half budgets. Times are
+			 copied to the stack to be ranked.
+*   @return  The summary.
+*/
+FrameStats::Summary FrameStats::summarise() const
+{
+	Summary summary;
+	summary.frames = size();
+	summary.total_over_budget = total_over_budget;
+	summary.bucket_ms = budget_ms / 2;
+
+	std::array<float, CAPACITY> times;
+	for (size_t i = 0; i < summary.frames; i++)
+	{
+		auto frame_ms = samples[i].frame_ms;
+		times[i] = frame_ms;
+
+		size_t bucket = 0;
+		while (bucket + 1 < BUCKETS && frame_ms > summary.bucket_ms * (bucket + 1))
+		{
+			bucket++;
+		}
+		summary.histogram[bucket]++;
+		if (frame_ms > budget_ms)
+		{
+			summary.over_budget++;
+		}
+	}
+	summary.frame = spread(times.data(), summary.frames);
+
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		for (size_t i = 0; i < summary.frames; i++)
+		{
+			times[i] = samples[i].phase_ms[phase];
+		}
+		summary.phases[phase] = spread(times.data(), summary.frames);
+	}
+
+	return summary;
+}
+
+void FrameStats::record(RenderCommandList& commands, int x, int y, const ASGE::Colour& colour)
+{
+	auto lines = layout(summarise());
+	for (size_t line = 0; line < lines; line++)
+	{
+		commands.addText(text[line], lengths[line],
+			x, y + static_cast<int>(line) * LINE_HEIGHT, 1.0f, colour);
+	}
+}
+
+/**
+*   @brief   Writes the summary as text.
+*   @details The same lines as the panel drawn over the game, laid
+			 out in the panel's buffers.
+*   @return  void
+*/
+void FrameStats::print(std::FILE* out)
+{
+	auto lines = layout(summarise());
+	for (size_t line = 0; line < lines; line++)
+	{
+		std::fprintf(out, "%s\n", text[line]);
+	}
+}
+
+const char* FrameStats::phaseName(Phase phase)
+{
+	switch (phase)
+	{
+	case SIMULATE: return "simulate";
+	case RECORD:   return "record";
+	case RENDER:   return "render";
+	case WAIT:     return "wait";
+	default:       return "";
+	}
+}
+
+/**
+*   @brief   Lays out the summary as lines of text.
+*   @details A table of each time's spread, the frames over budget,
+			 then the histogram as bars scaled to the fullest bucket.
+*   @return  The number of lines.
+*/
+size_t FrameStats::layout(const Summary& summary)
+{
+	size_t line = 0;
+	line = format(line, "%-9s %6s %6s %6s %6s", "ms", "p50", "p95", "p99", "max");
+	line = format(line, "%-9s %6.2f %6.2f %6.2f %6.2f", "frame",
+		summary.frame.p50, summary.frame.p95, summary.frame.p99, summary.frame.max);
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		const auto& times = summary.phases[phase];
+		line = format(line, "%-9s %6.2f %6.2f %6.2f %6.2f", phaseName(static_cast<Phase>(phase)),
+			times.p50, times.p95, times.p99, times.max);
+	}
+	line = format(line, "over %.1fms: %zu of %zu (%lld in all)", budget_ms,
+		summary.over_budget, summary.frames, summary.total_over_budget);
+
+	uint32_t fullest = 1;
+	for (auto frames : summary.histogram)
+	{
+		fullest = std::max(fullest, frames);
+	}
+
+	char bar[BAR_WIDTH + 2] = " ";
+	for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+	{
+		auto width = static_cast<size_t>(BAR_WIDTH * summary.histogram[bucket] / fullest);
+		if (width == 0 && summary.histogram[bucket] > 0)
+		{
+			width = 1;
+		}
+		std::fill(bar + 1, bar + 1 + width, '#');
+		bar[width + 1] = '\0';
+
+		line = format(line, "%s%5.1f %5u%s", bucket + 1 < BUCKETS ? "<=" : "> ",
+			bucket + 1 < BUCKETS ? summary.bucket_ms * (bucket + 1) : summary.bucket_ms * bucket,
+			summary.histogram[bucket], width ? bar : "");
+	}
+
+	return line;
+}
+
+/**
+*   @brief   Formats one line of the panel.
+*   @details Text that does not fit the line's buffer is cut short.
+*   @return  The next line.
+*/
+size_t FrameStats::format(size_t line, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int written = std::vsnprintf(text[line], TEXT_SIZE, format, args);
+	va_end(args);
+
+	lengths[line] = written < 0 ? 0 :
+		written < static_cast<int>(TEXT_SIZE) ? static_cast<size_t>(written) : TEXT_SIZE - 1;
+	return line + 1;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <Engine/Colours.h>
+
+#include "RenderCommands.h"
+
+/**
+*  Frame times over the most recent frames, for finding hitches that
+*  an average hides.
+*  Each frame's length is kept along with how long each phase of the
+*  frame took. The length is the frame's game time, or in headless
+*  builds, whose game time is a fixed step, the time the clock says
+*  the frame took. Samples are kept in a fixed ring,
+*  so adding one never allocates. The kept frames can be summarised as
+*  percentiles, a histogram and a count of frames over budget, drawn
+*  as a panel over the game or printed.
+*/
+class FrameStats
+{
+public:
+
+	/**
+	*  The parts of a frame that are timed.
+	*/
+	enum Phase : uint8_t
+	{
+		SIMULATE,   /**< Running the frame's ticks. */
+		RECORD,     /**< Recording the frame to draw. */
+		RENDER,     /**< Drawing the recorded frame. */
+		WAIT,       /**< Waiting for a pipelined simulation. */
+		PHASE_COUNT
+	};
+
+	static const size_t CAPACITY = 512;
+	static const size_t BUCKETS = 8;
+
+	/**
+	*  One frame's times, in milliseconds.
+	*/
+	struct Sample
+	{
+		float frame_ms = 0;
+		float phase_ms[PHASE_COUNT]{};
+	};
+
+	/**
+	*  How a time was spread over the kept frames, in milliseconds.
+	*/
+	struct Spread
+	{
+		float mean = 0;
+		float p50 = 0;
+		float p95 = 0;
+		float p99 = 0;
+		float max = 0;
+	};
+
+	/**
+	*  A summary of the kept frames.
+	*  Bucket i of the histogram counts frames longer than i bucket
+	*  widths, up to i + 1; the last also counts every longer frame.
+	*/
+	struct Summary
+	{
+		size_t frames = 0;
+		Spread frame;
+		Spread phases[PHASE_COUNT];
+		size_t over_budget = 0;            /**< Kept frames longer than the budget. */
+		long long total_over_budget = 0;   /**< Frames longer than the budget since the start. */
+		float bucket_ms = 0;
+		uint32_t histogram[BUCKETS]{};
+	};
+
+	/**
+	*  Sets the longest a frame may take before it counts as a hitch.
+	*  Defaults to a 60Hz frame.
+	*  @param [in] ms The budget, in milliseconds.
+	*/
+	void setBudget(double ms);
+
+	/**
+	*  Adds a frame, replacing the oldest once the ring is full.
+	*  @param [in] sample The frame's times.
+	*/
+	void add(const Sample& sample);
+
+	/**
+	*  Returns the number of frames kept.
+	*  @return the frame count.
+	*/
+	size_t size() const;
+
+	/**
+	*  Summarises the kept frames.
+	*  @return the summary.
+	*/
+	Summary summarise() const;
+
+	/**
+	*  Adds the summary to a frame as lines of text.
+	*  The text is laid out in fixed buffers, so nothing is allocated.
+	*  @param [in] commands The frame being recorded.
+	*  @param [in] x The panel's position in the X axis.
+	*  @param [in] y The first line's position in the Y axis.
+	*  @param [in] colour The colour of the text.
+	*/
+	void record(RenderCommandList& commands, int x, int y, const ASGE::Colour& colour);
+
+	/**
+	*  Writes the summary as text.
+	*  @param [in] out The file to write to.
+	*/
+	void print(std::FILE* out);
+
+	/**
+	*  Returns a phase's name.
+	*  @param [in] phase The phase.
+	*  @return the name.
+	*/
+	static const char* phaseName(Phase phase);
+
+private:
+	static const size_t LINES = PHASE_COUNT + 3 + BUCKETS;
+	static const size_t TEXT_SIZE = 48;
+	static const int LINE_HEIGHT = 20;
+	static const int BAR_WIDTH = 24;
+
+	size_t layout(const Summary& summary);
+	size_t format(size_t line, const char* format, ...);
+
+	std::array<Sample, CAPACITY> samples;
+	size_t count = 0;
+	float budget_ms = 1000.0f / 60;
+	long long total_over_budget = 0;
+
+	char text[LINES][TEXT_SIZE]{};
+	size_t lengths[LINES]{};
+};
@@ -1,11 +1,19 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <limits>
 #include <string>
+#include <thread>
 
 #include <Engine/Keys.h>
 #include <Engine/Input.h>
 #include <Engine/InputEvents.h>
 #include <Engine/Sprite.h>
 
+#include "EventSimulation.h"
 #include "Game.h"
+#include "Profiler.h"
 
 /**
 *   @brief   Default Constructor.
@@ -14,8 +22,18 @@
 */
 BreakoutGame::BreakoutGame()
 {
-
-
+	pipelined = std::thread::hardware_concurrency() > 1;
+	seed = static_cast<uint32_t>(time(NULL));
+	buildTickGraph();
+
+	// a step never takes more keys than the queue holds
+	step_keys.reserve(KEY_QUEUE_SIZE);
+
+#ifdef HEADLESS
+	// headless frames take no real time, so keys sent between them are
+	// applied at the start of the next step, keeping runs repeatable
+	timed_input = false;
+#endif
 }
 
 /**
@@ -24,21 +42,60 @@ BreakoutGame::BreakoutGame()
 */
 BreakoutGame::~BreakoutGame()
 {
+	simulation.reset();
+
 	this->inputs->unregisterCallback(key_callback_id);
 	this->inputs->unregisterCallback(mouse_callback_id);
 
+	frame_player.release(renderer.get());
+}
+
+namespace
+{
+	// every image the game draws, named by its atlas frame
+	const char* const SPRITE_FRAMES[] = {
+		"paddleBlue",
+		"ballBlue",
+		"element_red_rectangle_glossy",
+		"element_blue_rectangle_glossy",
+		"element_yellow_diamond_glossy" };
+
+	rect mergeRects(const rect& a, const rect& b)
+	{
+		rect bounds;
+		bounds.x = std::min(a.x, b.x);
+		bounds.y = std::min(a.y, b.y);
+		bounds.length = std::max(a.x + a.length, b.x + b.length) - bounds.x;
+		bounds.height = std::max(a.y + a.height, b.y + b.height) - bounds.y;
+		return bounds;
+	}
 
+	double millisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	}
+
+	float lerp(float from, float to, float alpha)
+	{
+		return from + (to - from) * alpha;
+	}
 }
 
 /**
 *   @brief   Initialises the game.
-*   @details The game window is created and all assets required to
-			 run the game are loaded. The keyHandler and clickHandler
-			 callback should also be set in the initialise function.
+*   @details The game window is created and the textures start
+			 loading in the background. The menu only needs the
+			 font, so init returns straight away and the sprites
+			 are created once loading completes. The keyHandler and
+			 clickHandler callback should also be set in the
+			 initialise function.
 *   @return  True if the game initialised correctly.
 */
 bool BreakoutGame::init()
 {
+	startup_begin = std::chrono::steady_clock::now();
+
 	setupResolution();
 	if (!initAPI())
 	{
@@ -46,12 +103,33 @@ bool BreakoutGame::init()
 	}
 
 
-	srand(time(NULL));
+	random.seed(seed);
+	jobs.reset(new JobSystem(job_threads));
+	if (record_session)
+	{
+		session_recording.reset(seed, tick_ms, scene);
+	}
+
 	toggleFPS();
+	score_counter = hud.addCounter("Score: ", 20, game_height - 20);
+	lives_counter = hud.addCounter("Lives: ", 20, game_height - 40);
+	gem_counter = hud.addCounter("Gem Chance: ", 20, game_height - 60);
 	renderer->setWindowTitle("Breakout!");
 
-	// input handling functions
+	// input handling functions; the key queue is safe to push from any
+	// thread, but callbacks on the polling thread need no handoff and
+	// arrive in order
 	inputs->use_threads = false;
+	last_step_time = startup_begin;
+
+	textures.reset(new TextureCache(renderer.get()));
+	if (archive.open("./Resources/assets.pak"))
+	{
+		textures->setArchive(&archive);
+	}
+
+	atlas.reset(new TextureAtlas(*textures,
+		"./Resources/Textures/puzzlepack/png/"));
 
 	key_callback_id = inputs->addCallbackFnc(
 		ASGE::E_KEY, &BreakoutGame::keyHandler, this);
@@ -59,103 +137,298 @@ bool BreakoutGame::init()
 	mouse_callback_id =inputs->addCallbackFnc(
 		ASGE::E_MOUSE_CLICK, &BreakoutGame::clickHandler, this);
 
-	if (!paddle.addSpriteComponent(renderer.get(),
-		".\\Resources\\Textures\\puzzlepack\\png\\paddleBlue.png"))
+	loadAssets();
+
+	startup_init_ms = millisecondsSince(startup_begin);
+	return true;
+}
+
+/**
+*   @brief   Starts loading the game's textures.
+*   @details The images are read and decoded on worker threads.
+			 As each one finishes its pixels are uploaded on the main
+			 thread and held in the texture cache, so creating the
+			 sprites afterwards does not touch the disk. ASGE's own
+			 sprites can only load files, so for them the upload
+			 reads the file again, from the OS cache. Only the atlas is
+			 needed when it is present, otherwise each image is.
+			 Textures mapped from the asset archive need no decoding
+			 and are loaded immediately.
+*   @return  void
+*/
+void BreakoutGame::loadAssets()
+{
+	loader.reset(new AssetLoader());
+
+	std::vector<std::string> files;
+	if (atlas->loadManifest("./Resources/Textures/puzzlepack/atlas/atlas.txt"))
 	{
-		return false;
+		files.push_back(atlas->textureFile());
 	}
-	paddle_sprite = paddle.spriteComponent()->getSprite();
-	paddle_sprite->xPos((game_width - paddle_sprite->width() )/ 2);
-	paddle_sprite->yPos(game_height - 50);
-
-	if (!ball.addSpriteComponent(renderer.get(),
-		".\\Resources\\Textures\\puzzlepack\\png\\ballBlue.png"))
+	else
 	{
-		return false;
+		for (auto frame : SPRITE_FRAMES)
+		{
+			files.push_back(atlas->looseFile(frame));
+		}
 	}
-	ball_sprite = ball.spriteComponent()->getSprite();
-	
-	
-	for (int i = 0; i < block_array_size; i++)
 
+	for (const auto& file : files)
 	{
-		if (block_row % 2 == 0)
+		if (textures->isMapped(file))
 		{
-			if (i % 2 == 0)
+			auto sprite = textures->acquire(file);
+			if (sprite)
 			{
-				if (!blocks[i].addSpriteComponent(renderer.get(),
-					".\\Resources\\Textures\\puzzlepack\\png\\element_red_rectangle_glossy.png"))
-				{
-					blocks[i].addSpriteComponent(renderer.get(),
-						".\\Resources\\Textures\\puzzlepack\\png\\element_red_rectangle_glossy.png");
-				}
+				preloaded.push_back(sprite);
 			}
-			else
-				if (!blocks[i].addSpriteComponent(renderer.get(),
-					".\\Resources\\Textures\\puzzlepack\\png\\element_blue_rectangle_glossy.png"))
-				{
-					blocks[i].addSpriteComponent(renderer.get(),
-						".\\Resources\\Textures\\puzzlepack\\png\\element_blue_rectangle_glossy.png");
-				}
+			continue;
 		}
-		else
+
+		loader->load(file, [this](const std::string& file_name, Png::Image& image)
 		{
-			if (i % 2 == 0)
+			// sprites that take pixels from memory upload the worker's
+			// image; ASGE's only load files, so re-read the cached file
+			auto sprite = textures->acquire(file_name, image);
+			if (sprite)
 			{
-				if (!blocks[i].addSpriteComponent(renderer.get(),
-					".\\Resources\\Textures\\puzzlepack\\png\\element_blue_rectangle_glossy.png"))
-				{
-					blocks[i].addSpriteComponent(renderer.get(),
-						".\\Resources\\Textures\\puzzlepack\\png\\element_blue_rectangle_glossy.png");
-				}
+				preloaded.push_back(sprite);
 			}
-			else
-				if (!blocks[i].addSpriteComponent(renderer.get(),
-					".\\Resources\\Textures\\puzzlepack\\png\\element_red_rectangle_glossy.png"))
-				{
-					blocks[i].addSpriteComponent(renderer.get(),
-						".\\Resources\\Textures\\puzzlepack\\png\\element_red_rectangle_glossy.png");
-				}
-
-		}
+		});
+	}
+}
 
+/**
+*   @brief   Creates the game's sprites.
+*   @details Called once the textures have loaded, so every sprite
+			 is served from the texture cache.
+*   @return  True if every sprite was created.
+*/
+bool BreakoutGame::initSprites()
+{
+	// every sprite draws from the atlas when it is present, so the
+	// deferred batch is only broken by the text drawn after them
+	if (atlas->loadTexture())
+	{
+		renderer->setSpriteMode(ASGE::SpriteSortMode::DEFERRED);
+	}
 
-		block_sprite = blocks[i].spriteComponent()->getSprite();
-		block_sprite->xPos(x_pos);
-		block_sprite->yPos(y_pos);
+	if (!paddle.addSpriteComponent(*atlas, "paddleBlue"))
+	{
+		return false;
+	}
+	paddle_sprite = paddle.spriteComponent()->getSprite();
+	paddle_sprite->xPos((game_width - paddle_sprite->width() )/ 2);
+	paddle_sprite->yPos(game_height - 50);
 
-		x_pos += (block_sprite->width() + 10);
+	if (!ball.addSpriteComponent(*atlas, "ballBlue"))
+	{
+		return false;
+	}
+	ball_sprite = ball.spriteComponent()->getSprite();
 
-		if (x_pos + block_sprite->width() >= game_width)
-		{
-			block_row++;
-			x_pos = 20;
-			y_pos = block_row * 35;
-		}
-		
-		blocks[i].visibility = true;
-		
+	SceneGenerator generator(scene,
+		static_cast<float>(game_width), static_cast<float>(game_height), seed);
+	if (!initBlocks(generator) || !initGems(generator) || !initBalls(generator))
+	{
+		return false;
 	}
 
-	initGems();
+	initBrickGrid();
 	respawn();
+	savePrevious();
+
+	// the sprites hold their own references now
+	for (auto sprite : preloaded)
+	{
+		textures->release(sprite);
+	}
+	preloaded.clear();
+
+	assets_ready = true;
+	startup_ready_ms = millisecondsSince(startup_begin);
 
 	return true;
 }
 
-void BreakoutGame::initGems()
+/**
+*   @brief   Waits for the remaining assets.
+*   @details For callers that need the game playable straight away
+			 rather than loading behind the menu.
+*   @return  True if the sprites were created.
+*/
+bool BreakoutGame::finishLoading()
 {
-	for (int i = 0; i < gem_array_size; i++)
+	if (assets_ready)
+	{
+		return true;
+	}
+
+	while (loader->update(std::numeric_limits<size_t>::max()) > 0)
+	{
+		std::this_thread::yield();
+	}
+
+	return initSprites();
+}
+
+/**
+*   @brief   Lays out the blocks.
+*   @details Every block of a colour shares one sprite, the blocks
+			 themselves only store their bounds and a sprite handle.
+			 The generator places them, scaling them down to fit
+			 dense layouts.
+*   @return  True if the block sprites loaded.
+*/
+bool BreakoutGame::initBlocks(SceneGenerator& generator)
+{
+	auto red = addEntitySprite("element_red_rectangle_glossy");
+	auto blue = addEntitySprite("element_blue_rectangle_glossy");
+
+	if (red < 0 || blue < 0)
+	{
+		return false;
+	}
+
+	auto sprite = entity_sprites[red]->getSprite();
+	std::vector<SceneBrick> layout;
+	generator.layoutBricks(sprite->width(), sprite->height(), layout);
+
+	blocks.clear();
+	blocks.reserve(layout.size());
+	for (const auto& brick : layout)
+	{
+		blocks.add(brick.bounds, brick.alternate ? blue : red);
+		brick_area = blocks.size() == 1 ? brick.bounds : mergeRects(brick_area, brick.bounds);
+	}
+
+	number_of_blocks = static_cast<int>(blocks.size());
+	return true;
+}
+
+/**
+*   @brief   Builds the brick spatial index.
+*   @details The cells are sized to the largest brick so each
+			 brick is registered with at most four cells. Must be
+			 called once the blocks have been positioned.
+*   @return  void
+*/
+void BreakoutGame::initBrickGrid()
+{
+	float cell_size = 0;
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		cell_size = std::max(cell_size,
+			std::max(blocks.bounds.length[i], blocks.bounds.height[i]));
+	}
+
+	auto count = static_cast<int>(blocks.size());
+	brick_grid.reset(game_width, game_height, cell_size, count);
+	for (int i = 0; i < count; i++)
+	{
+		if (blocks.visible[i])
+		{
+			brick_grid.insert(i, blocks.boundingBox(i));
+		}
+	}
+}
+
+/**
+*   @brief   Creates the gems.
+*   @details Gems share a single sprite. They start hidden, apart
+			 from any the scene has falling from the start, which are
+			 the last gems so spawning reaches them last.
+*   @return  True if the gem sprite loaded.
+*/
+bool BreakoutGame::initGems(SceneGenerator& generator)
+{
+	auto gem = addEntitySprite("element_yellow_diamond_glossy");
+
+	if (gem < 0)
+	{
+		return false;
+	}
+
+	auto sprite = entity_sprites[gem]->getSprite();
+	rect bounds;
+	bounds.length = sprite->width();
+	bounds.height = sprite->height();
+
+	auto hidden = scene.gems - scene.falling_gems;
+	gems.clear();
+	gems.reserve(scene.gems);
+	for (int i = 0; i < scene.gems; i++)
 	{
-		if (!gems[i].addSpriteComponent(renderer.get(),
-			".\\Resources\\Textures\\puzzlepack\\png\\element_yellow_diamond_glossy.png"))
+		auto idx = gems.add(bounds, gem);
+		gems.visible[idx] = i >= hidden;
+		if (gems.visible[idx])
 		{
-			gems[i].addSpriteComponent(renderer.get(),
-				".\\Resources\\Textures\\puzzlepack\\png\\element_yellow_diamond_glossy.png");
+			auto box = gems.boundingBox(idx);
+			generator.placeGem(box);
+			gems.bounds.x[idx] = box.x;
+			gems.bounds.y[idx] = box.y;
+			gems.vel_y[idx] = gem_speed;
 		}
+	}
 
-		gems[i].visibility = false;
+	gems_expired.assign(gems.size(), 0);
+	number_of_gems = hidden;
+	return true;
+}
+
+/**
+*   @brief   Creates the balls other than the player's.
+*   @details They share the player's ball's image, and move at
+			 its speed from where the generator places them.
+*   @return  True if the ball sprite loaded, or none were needed.
+*/
+bool BreakoutGame::initBalls(SceneGenerator& generator)
+{
+	extra_balls.clear();
+	if (scene.balls <= 1)
+	{
+		return true;
+	}
+
+	auto handle = addEntitySprite("ballBlue");
+	if (handle < 0)
+	{
+		return false;
 	}
+
+	rect bounds = ball.spriteComponent()->getBoundingBox();
+	extra_balls.reserve(scene.balls - 1);
+	for (int i = 1; i < scene.balls; i++)
+	{
+		vector2 direction = { 0, -1 };
+		generator.placeBall(bounds, direction);
+
+		auto idx = extra_balls.add(bounds, handle);
+		extra_balls.vel_x[idx] = direction.x * ball.speed;
+		extra_balls.vel_y[idx] = direction.y * ball.speed;
+	}
+
+	return true;
+}
+
+/**
+*   @brief   Loads a sprite shared by many entities.
+*   @details Entities refer to the sprite by the returned handle
+			 and it is positioned just before each entity is drawn.
+			 Sprites show a frame of the atlas, or come from the
+			 texture cache when the atlas is missing.
+*   @return  The sprite's handle, or -1 if it failed to load.
+*/
+int BreakoutGame::addEntitySprite(const std::string& frame_name)
+{
+	std::unique_ptr<SpriteComponent> component(new SpriteComponent());
+	if (!component->loadSprite(*atlas, frame_name))
+	{
+		return -1;
+	}
+
+	entity_sprites.push_back(std::move(component));
+	return static_cast<int>(entity_sprites.size()) - 1;
 }
 
 /**
@@ -179,9 +452,11 @@ void BreakoutGame::setupResolution()
 /**
 *   @brief   Processes any key inputs
 *   @details This function is added as a callback to handle the game's
-			 keyboard input. For this game, calls to this function
-			 are thread safe, so you may alter the game's state as you
-			 see fit.
+			 keyboard input. The game may be simulating on another
+			 thread, so events are timed and pushed to the key queue,
+			 to be applied by the simulation, see drainInput. If the
+			 queue is full the event is dropped, except a release,
+			 which is kept aside so the paddle cannot be left moving.
 *   @param   data The event data relating to key input.
 *   @see     KeyEvent
 *   @return  void
@@ -195,26 +470,146 @@ void BreakoutGame::keyHandler(const ASGE::SharedEventData data)
 		signalExit();
 	}
 
-	if (key->key == ASGE::KEYS::KEY_ENTER)
+	KeyInput input;
+	input.key = *key;
+	if (timed_input)
+	{
+		input.time = std::chrono::steady_clock::now();
+	}
+	if (!key_queue.push(input) && key->action == ASGE::KEYS::KEY_RELEASED)
+	{
+		dropped_release_time.store(input.time.time_since_epoch().count(), std::memory_order_relaxed);
+		dropped_release.store(key->key, std::memory_order_release);
+	}
+}
+
+/**
+*   @brief   Takes the key events queued since the last step
+*   @details Called by the simulation before each step, on whichever
+			 thread it runs. The step covers the time since the
+			 last one began, so each event is placed on the tick
+			 of the step it came during, and how far into it.
+			 Untimed events, and any while not playing, are placed
+			 at the start of the step. A release dropped from the
+			 full queue is added back, at the time it came.
+*   @return  void
+*/
+void BreakoutGame::drainInput()
+{
+	auto step_ms = step_time.delta_time.count();
+	auto step_begin = last_step_time;
+	last_step_time = step_time.frame_time;
+
+	step_keys.clear();
+	next_key = 0;
+
+	auto place = [&](KeyInput& input)
+	{
+		input.step = 0;
+		input.offset = 0;
+		if (timed_input && assets_ready && !in_menu)
+		{
+			auto at_ms = std::chrono::duration<double, std::milli>(input.time - step_begin).count();
+			at_ms = std::min(std::max(at_ms, 0.0), step_ms);
+
+			// ticks are due once the time carried over and this step's
+			// time reach a tick's length
+			auto tick_position = (tick_accumulator + at_ms) / tick_ms;
+			input.step = static_cast<int>(tick_position);
+			input.offset = static_cast<float>(tick_position - input.step);
+		}
+		step_keys.push_back(input);
+	};
+
+	KeyInput input;
+	while (key_queue.pop(input))
+	{
+		place(input);
+	}
+
+	int released = dropped_release.exchange(NO_KEY, std::memory_order_acquire);
+	if (released != NO_KEY)
+	{
+		KeyInput release;
+		release.key.key = released;
+		release.key.action = ASGE::KEYS::KEY_RELEASED;
+		release.key.mods = 0;
+		release.time = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(
+			dropped_release_time.load(std::memory_order_relaxed)));
+		place(release);
+	}
+
+	// pushers may be on several threads, so put the events in time order
+	std::stable_sort(step_keys.begin(), step_keys.end(),
+		[](const KeyInput& a, const KeyInput& b)
+		{
+			return a.step < b.step || (a.step == b.step && a.offset < b.offset);
+		});
+}
+
+/**
+*   @brief   Applies the key events due before a tick of the step
+*   @details When recording, each event is recorded against the
+			 tick it is applied before, with how far into it the
+			 event took effect.
+*   @return  void
+*/
+void BreakoutGame::applyInput(int step)
+{
+	for (; next_key < step_keys.size() && step_keys[next_key].step <= step; next_key++)
+	{
+		const auto& input = step_keys[next_key];
+		if (record_session)
+		{
+			session_recording.addInput(static_cast<uint32_t>(ticks),
+				input.key.key, input.key.action, input.key.mods, input.offset);
+		}
+		handleKey(input.key, input.offset);
+	}
+}
+
+/**
+*   @brief   Applies a key event to the game
+*   @details Paddle keys change its velocity part way into the
+			 coming tick, given by the offset, so the tick's travel
+			 up to then is kept at the old velocity.
+*   @return  void
+*/
+void BreakoutGame::handleKey(const ASGE::KeyEvent& key, float offset)
+{
+	if (key.key == ASGE::KEYS::KEY_ENTER && assets_ready)
 	{
 		in_menu = false;
 	}
-	if (key->action == ASGE::KEYS::KEY_PRESSED)
+
+	auto velocity = paddle.get_vel_x();
+	if (key.action == ASGE::KEYS::KEY_PRESSED)
 	{
-		if (key->key == ASGE::KEYS::KEY_A)
+		if (key.key == ASGE::KEYS::KEY_A)
 		{
-			paddle.set_vel_x(-1);
+			velocity = -1;
 		}
-		if (key->key == ASGE::KEYS::KEY_D)
+		if (key.key == ASGE::KEYS::KEY_D)
 		{
-			paddle.set_vel_x(1);
+			velocity = 1;
+		}
+		if (key.key == ASGE::KEYS::KEY_F)
+		{
+			show_stats = !show_stats;
 		}
 	}
-	else if (key->action == ASGE::KEYS::KEY_RELEASED)
+	else if (key.action == ASGE::KEYS::KEY_RELEASED)
 	{
-		paddle.set_vel_x(0);
+		velocity = 0;
 	}
 
+	if (velocity != paddle.get_vel_x())
+	{
+		offset = std::max(offset, paddle_input_offset);
+		paddle_input_lead += paddle.get_vel_x() * (offset - paddle_input_offset);
+		paddle_input_offset = offset;
+		paddle.set_vel_x(velocity);
+	}
 }
 
 /**
@@ -229,8 +624,6 @@ void BreakoutGame::keyHandler(const ASGE::SharedEventData data)
 */
 void BreakoutGame::clickHandler(const ASGE::SharedEventData data)
 {
-	auto click = static_cast<const ASGE::ClickEvent*>(data.get());
-
 	double x_pos, y_pos;
 	inputs->getCursorPos(x_pos, y_pos);
 }
@@ -238,95 +631,650 @@ void BreakoutGame::clickHandler(const ASGE::SharedEventData data)
 
 /**
 *   @brief   Updates the scene
-*   @details Prepares the renderer subsystem before drawing the
-		     current frame. Once the current frame is has finished
-		     the buffers are swapped accordingly and the image shown.
+*   @details Steps the simulation, which records the frame for render
+			 to draw. Once loaded, with the atlas, the step may run on
+			 the simulation thread, so it overlaps with drawing the
+			 previous frame. While waiting for the last step, the
+			 main thread runs its jobs. Textures are uploaded here,
+			 on the main thread, while loading.
 *   @return  void
 */
 void BreakoutGame::update(const ASGE::GameTime& us)
 {
+	PROFILE_ZONE("update");
+	if (!assets_ready)
+	{
+		// upload one texture per frame so the menu keeps drawing
+		if (loader->update(1) == 0 && !initSprites())
+		{
+			signalExit();
+		}
+
+		sampleFrame(us);
+		step_time = us;
+		simulate();
+		return;
+	}
+
+	if (pipelined && atlas->loaded())
+	{
+		if (!simulation)
+		{
+			simulation.reset(new StepThread([this] { simulate(); }));
+		}
 
-	auto dt_sec = us.delta_time.count() / 1000.0;
+		// help with the step's jobs rather than blocking on it
+		auto wait_begin = std::chrono::steady_clock::now();
+		jobs->help([this] { return !simulation->busy(); });
+		simulation->wait();
+		frame_sample.phase_ms[FrameStats::WAIT] =
+			static_cast<float>(millisecondsSince(wait_begin));
+
+		sampleFrame(us);
+		step_time = us;
+		simulation->run();
+		return;
+	}
 
+	sampleFrame(us);
+	step_time = us;
+	simulate();
+}
 
-	//make sure you use delta time in any movement calculations!
-	if (!in_menu)
+/**
+*   @brief   Starts timing a frame
+*   @details Adds the last frame's times to the statistics, then
+			 starts the new frame's, whose length is the time since
+			 the last frame. That is its game time, except headless,
+			 where every frame advances game time by the same step
+			 however long it takes, so the clock is read instead.
+			 Only called while the simulation is idle, as it reads
+			 the statistics.
+*   @return  void
+*/
+void BreakoutGame::sampleFrame(const ASGE::GameTime& us)
+{
+	if (frame_sampled)
+	{
+		frame_stats.add(frame_sample);
+	}
+
+	frame_sample = FrameStats::Sample();
+	frame_sample.frame_ms = static_cast<float>(us.delta_time.count());
+#ifdef HEADLESS
+	if (frame_sampled)
+	{
+		frame_sample.frame_ms = static_cast<float>(millisecondsSince(frame_begin));
+	}
+	frame_begin = std::chrono::steady_clock::now();
+#endif
+	frame_sampled = true;
+}
+
+/**
+*   @brief   Runs one step of the game
+*   @details Runs as many fixed ticks as the frame's time covers,
+			 applying each key event before the tick it came during,
+			 and records the frame. Time left over is
+			 carried to the next step. If the game falls too far
+			 behind, the extra time is dropped rather than making
+			 every later step slower still. Touches only the game's
+			 own state, never the renderer, so it can run on the
+			 simulation thread.
+*   @return  void
+*/
+void BreakoutGame::simulate()
+{
+	PROFILE_ZONE("simulate");
+	drainInput();
+	applyInput(0);
+
+	auto simulate_begin = std::chrono::steady_clock::now();
+	if (assets_ready && !in_menu)
 	{
-		paddleMovement(dt_sec);
-		ballMovement(dt_sec);
-		collision(us);
-		gemMovement(dt_sec);
+		tick_accumulator += step_time.delta_time.count();
+
+		int steps = 0;
+		while (tick_accumulator >= tick_ms)
+		{
+			if (steps == max_ticks_per_step)
+			{
+				tick_accumulator = std::fmod(tick_accumulator, tick_ms);
+				break;
+			}
+
+			applyInput(steps);
+			tick();
+			tick_accumulator -= tick_ms;
+			steps++;
+		}
 	}
+
+	// the rest came after the last tick, so take effect in the next
+	applyInput(std::numeric_limits<int>::max());
+
+	auto record_begin = std::chrono::steady_clock::now();
+	frame_sample.phase_ms[FrameStats::SIMULATE] = static_cast<float>(
+		std::chrono::duration<double, std::milli>(record_begin - simulate_begin).count());
+
+	recordFrame(frames.writeBuffer());
+	frames.publish();
+	frame_sample.phase_ms[FrameStats::RECORD] =
+		static_cast<float>(millisecondsSince(record_begin));
+}
+
+/**
+*   @brief   Advances play by one tick
+*   @details Every tick is the same length, so play depends only on
+			 the input and not on how often frames are drawn. The
+			 game time passed on counts simulated time. The tick's
+			 work runs as the jobs of the tick graph.
+*   @return  void
+*/
+void BreakoutGame::tick()
+{
+	PROFILE_ZONE("tick");
+	savePrevious();
+
+	ticks++;
+	tick_time.delta_time = std::chrono::duration<double, std::milli>(tick_ms);
+	tick_time.game_time = std::chrono::milliseconds(
+		static_cast<long long>(ticks * tick_ms));
+
+	tick_sec = static_cast<float>(tick_ms / 1000.0);
+	jobs->run(tick_graph);
+
+	if (record_session)
+	{
+		session_recording.addTick(stateHash());
+	}
+}
+
+/**
+*   @brief   Splits a tick into jobs
+*   @details The paddle moves before the ball, which is swept
+			 against it, and the bricks the ball hit are scored
+			 after that. Gems are moved over ranges in parallel,
+			 after scoring may have spawned one, then those that
+			 expired or were caught are counted. The order within
+			 a tick is the same as running the steps in turn, so
+			 play is the same on any number of threads.
+*   @return  void
+*/
+void BreakoutGame::buildTickGraph()
+{
+	auto paddle_job = tick_graph.add([this] { paddleMovement(tick_sec); });
+	auto ball_job = tick_graph.add([this] { ballMovement(tick_sec); });
+	auto collision_job = tick_graph.add([this] { collision(tick_time); });
+	auto gem_job = tick_graph.parallelFor([this] { return gems.size(); }, GEM_GRAIN,
+		[this](size_t begin, size_t end) { gemMovement(begin, end); });
+	auto catch_job = tick_graph.add([this] { gemCatch(); });
+
+	tick_graph.precede(paddle_job, ball_job);
+	tick_graph.precede(ball_job, collision_job);
+	tick_graph.precede(collision_job, gem_job);
+	tick_graph.precede(gem_job, catch_job);
+}
+
+/**
+*   @brief   Keeps the positions of everything that moves
+*   @details Frames are drawn between these and the current positions.
+			 Called before each tick, and after anything moves
+			 outside of one, so it is not drawn sliding there.
+*   @return  void
+*/
+void BreakoutGame::savePrevious()
+{
+	paddle_previous_x = paddle_sprite->xPos();
+	ball_previous.x = ball_sprite->xPos();
+	ball_previous.y = ball_sprite->yPos();
+	gem_previous.x = gems.bounds.x;
+	gem_previous.y = gems.bounds.y;
+	extra_ball_previous.x = extra_balls.bounds.x;
+	extra_ball_previous.y = extra_balls.bounds.y;
 }
 
 /**
 *   @brief   Renders the scene
-*   @details Renders all the game objects to the current frame.
-	         Once the current frame is has finished the buffers are
-			 swapped accordingly and the image shown.
+*   @details Draws the latest frame the simulation recorded. If none
+			 has been recorded since the last render, the last one is
+			 drawn again.
 *   @return  void
 */
 void BreakoutGame::render(const ASGE::GameTime &)
 {
+	PROFILE_ZONE("render");
+	auto render_begin = std::chrono::steady_clock::now();
 	renderer->setFont(0);
+	frames.acquire();
+	const auto& frame = frames.readBuffer();
+	frame_player.play(renderer.get(), frame);
+	if (frame.hasLayer())
+	{
+		layer_frame_drawn.store(frame.frameNumber(), std::memory_order_release);
+	}
+	frame_sample.phase_ms[FrameStats::RENDER] =
+		static_cast<float>(millisecondsSince(render_begin));
+}
+
+/**
+*   @brief   Records the frame to draw
+*   @details The bricks make up the static layer, recorded once
+			 when play starts. Each frame then names the bricks hidden
+			 since the last drawn frame with the layer, so only where
+			 they were is redrawn. Everything else is given a draw
+			 layer, which orders it when drawn.
+*   @return  void
+*/
+void BreakoutGame::recordFrame(RenderCommandList& commands)
+{
+	PROFILE_ZONE("recordFrame");
+	commands.clear();
+	commands.setFrameNumber(frames_recorded++);
+	commands.setDrawLayer(HUD_LAYER);
 
-	if (in_menu)
+	if (!assets_ready)
+	{
+		commands.addText("Loading...",
+			(game_width / 2) - 160, game_height / 2, ASGE::COLOURS::WHITE);
+	}
+	else if (in_menu)
 	{
-		renderer->renderText("Press Enter to continue",
+		commands.addText("Press Enter to continue",
 			(game_width / 2) - 160, game_height / 2, ASGE::COLOURS::WHITE);
 	}
 	else if (number_of_blocks <= 0)
 	{
-		renderer->renderText("Congratulations",
+		commands.addText("Congratulations",
 			(game_width / 2) - 160, game_height / 2, ASGE::COLOURS::WHITE);
 	}
 	else if (lives <= 0)
 	{
-		renderer->renderText("You Lose",
+		commands.addText("You Lose",
 			(game_width / 2) - 160, game_height / 2, ASGE::COLOURS::WHITE);
 
 	}
 	else
 	{
-	
-		renderer->renderSprite(*paddle_sprite);
-		renderer->renderSprite(*ball_sprite);
-
-		std::string score_str = "Score: " + std::to_string(score);
-		renderer->renderText(score_str.c_str(),
-			20, game_height - 20, ASGE::COLOURS::WHITE);
-		std::string lives_str = "Lives: " + std::to_string(lives);
-		renderer->renderText(lives_str.c_str(),
-			20, game_height - 40, ASGE::COLOURS::WHITE);
-		std::string gem_str = "Gem Chance: " + std::to_string(gem_chance);
-		renderer->renderText(gem_str.c_str(),
-			20, game_height - 60, ASGE::COLOURS::WHITE);
-
-		for (int j = 0; j < block_array_size; j++)
-		{
-			if (blocks[j].visibility == true)
+		if (!brick_layer)
+		{
+			auto layer = std::make_shared<std::vector<SpriteCommand>>();
+			recordEntities(blocks, commands, layer.get());
+			brick_layer = layer;
+			brick_layer_removals.clear();
+		}
+
+		// forget the removals a drawn frame has already named
+		auto drawn = layer_frame_drawn.load(std::memory_order_acquire);
+		brick_layer_removals.erase(std::remove_if(brick_layer_removals.begin(),
+			brick_layer_removals.end(), [drawn](const LayerRemoval& removal)
 			{
-				renderer->renderSprite(*blocks[j].spriteComponent()->getSprite());
-			}
+				return removal.frame <= drawn;
+			}), brick_layer_removals.end());
+
+		commands.setLayer(brick_area, brick_layer);
+		for (const auto& removal : brick_layer_removals)
+		{
+			commands.removeLayerSprite(removal.brick);
 		}
 
-		for (int j = 0; j < gem_array_size; j++)
+		// draw the part of the way to the next tick already elapsed
+		auto alpha = static_cast<float>(tick_accumulator / tick_ms);
+
+		commands.setDrawLayer(GEM_LAYER);
+		recordEntities(gems, commands, nullptr, &gem_previous, alpha);
+
+		commands.setDrawLayer(PLAYER_LAYER);
+		recordEntities(extra_balls, commands, nullptr, &extra_ball_previous, alpha);
+
+		auto paddle_command = paddle.spriteComponent()->command();
+		paddle_command.instance.x = lerp(paddle_previous_x, paddle_sprite->xPos(), alpha);
+		commands.addSprite(paddle_command);
+
+		auto ball_command = ball.spriteComponent()->command();
+		ball_command.instance.x = lerp(ball_previous.x, ball_sprite->xPos(), alpha);
+		ball_command.instance.y = lerp(ball_previous.y, ball_sprite->yPos(), alpha);
+		commands.addSprite(ball_command);
+
+		hud.set(score_counter, score);
+		hud.set(lives_counter, lives);
+		hud.set(gem_counter, gem_chance);
+		commands.setDrawLayer(HUD_LAYER);
+		hud.record(commands, ASGE::COLOURS::WHITE);
+	}
+
+	if (show_stats)
+	{
+		commands.setDrawLayer(HUD_LAYER);
+		frame_stats.record(commands, 20, 300, ASGE::COLOURS::WHITE);
+	}
+}
+
+/**
+*   @brief   Removes a brick from play.
+*   @details The brick stops colliding, and once the static layer
+			 has been recorded, is named in the frames recorded from
+			 now on as removed from it, so its area is redrawn.
+*   @return  void
+*/
+void BreakoutGame::hideBrick(int brick)
+{
+	blocks.visible[brick] = false;
+	brick_grid.remove(brick);
+
+	if (brick_layer)
+	{
+		LayerRemoval removal;
+		removal.frame = frames_recorded;
+		removal.brick = brick;
+		brick_layer_removals.push_back(removal);
+	}
+}
+
+/**
+*   @brief   Records a set of entities
+*   @details Each visible entity is added as a copy of its sprite's
+			 command, moved to the entity. Given a layer, entities
+			 are added to it instead, keyed by their index. The renderer gathers entities sharing a
+			 texture into one batch when drawing. Given the positions
+			 before the last tick, entities are placed between them
+			 and their current positions.
+*   @return  void
+*/
+void BreakoutGame::recordEntities(const EntitySet& entities,
+	RenderCommandList& commands, std::vector<SpriteCommand>* layer,
+	const RectArray* previous, float alpha)
+{
+	entity_commands.resize(entity_sprites.size());
+	for (size_t handle = 0; handle < entity_sprites.size(); handle++)
+	{
+		entity_commands[handle] = entity_sprites[handle]->command();
+	}
+
+	auto count = entities.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!entities.visible[i])
 		{
-			if (gems[j].visibility == true)
-			{
-				renderer->renderSprite(*gems[j].spriteComponent()->getSprite());
-			}
+			continue;
+		}
+
+		auto command = entity_commands[entities.sprite[i]];
+		command.instance.x = entities.bounds.x[i];
+		command.instance.y = entities.bounds.y[i];
+		if (previous)
+		{
+			command.instance.x = lerp(previous->x[i], command.instance.x, alpha);
+			command.instance.y = lerp(previous->y[i], command.instance.y, alpha);
+		}
+		command.instance.width = entities.bounds.length[i];
+		command.instance.height = entities.bounds.height[i];
+		command.key = static_cast<int>(i);
+
+		if (layer)
+		{
+			layer->push_back(command);
+		}
+		else
+		{
+			commands.addSprite(command);
 		}
-	
 	}
 }
 
+void BreakoutGame::setPipelined(bool enabled)
+{
+	pipelined = enabled;
+}
+
+void BreakoutGame::setTickRate(double ticks_per_second)
+{
+	tick_ms = 1000.0 / ticks_per_second;
+}
+
+void BreakoutGame::setSeed(uint32_t new_seed)
+{
+	seed = new_seed;
+}
+
+void BreakoutGame::setJobThreads(unsigned thread_count)
+{
+	job_threads = thread_count;
+}
+
+void BreakoutGame::setScene(const SceneSettings& settings)
+{
+	scene = settings;
+	scene.bricks = std::max(1, scene.bricks);
+	scene.balls = std::max(1, scene.balls);
+	scene.gems = std::max(1, scene.gems);
+	scene.falling_gems = std::max(0, std::min(scene.falling_gems, scene.gems));
+}
+
+void BreakoutGame::startRecording()
+{
+	record_session = true;
+}
+
+bool BreakoutGame::saveRecording(const std::string& file_name)
+{
+	if (simulation)
+	{
+		simulation->wait();
+	}
+
+	return session_recording.save(file_name);
+}
+
+/**
+*   @brief   Replays a recorded session.
+*   @details Runs the recorded ticks back to back, applying each
+			 input before the tick it was recorded against. No
+			 frames are recorded until the end, when the final
+			 state is recorded once for render to draw.
+*   @return  The first tick whose state differed, or -1.
+*/
+long long BreakoutGame::replay(const Replay& session)
+{
+	if (simulation)
+	{
+		simulation->wait();
+	}
+
+	tick_ms = session.tickMs();
+	long long mismatch = -1;
+
+	const auto& inputs = session.inputs();
+	size_t next = 0;
+	auto applyInputs = [&](size_t tick)
+	{
+		for (; next < inputs.size() && inputs[next].tick <= tick; next++)
+		{
+			ASGE::KeyEvent key;
+			key.key = inputs[next].key;
+			key.action = inputs[next].action;
+			key.mods = inputs[next].mods;
+			handleKey(key, inputs[next].offset);
+		}
+	};
+
+	for (size_t tick_index = 0; tick_index < session.tickCount(); tick_index++)
+	{
+		applyInputs(tick_index);
+		tick();
+		if (mismatch < 0 && !session.matches(tick_index, stateHash()))
+		{
+			mismatch = static_cast<long long>(tick_index);
+		}
+	}
+	applyInputs(session.tickCount());
+
+	recordFrame(frames.writeBuffer());
+	frames.publish();
+	return mismatch;
+}
+
+BreakoutGame::Status BreakoutGame::status()
+{
+	if (simulation)
+	{
+		simulation->wait();
+	}
+
+	Status current;
+	current.score = score;
+	current.lives = lives;
+	current.bricks_left = number_of_blocks;
+	current.ticks = ticks;
+	if (assets_ready)
+	{
+		current.ball = ball.spriteComponent()->getBoundingBox();
+		current.paddle = paddle.spriteComponent()->getBoundingBox();
+	}
+	current.over = lives <= 0 || number_of_blocks <= 0;
+	return current;
+}
+
+FrameStats& BreakoutGame::frameStats()
+{
+	if (simulation)
+	{
+		simulation->wait();
+	}
+	return frame_stats;
+}
+
+void BreakoutGame::startupTimes(double& init_ms, double& ready_ms) const
+{
+	init_ms = startup_init_ms;
+	ready_ms = startup_ready_ms;
+}
+
+uint64_t BreakoutGame::droppedKeys() const
+{
+	return key_queue.dropped();
+}
+
+/**
+*   @brief   Hashes everything that play depends on
+*   @details Used to check that a replay follows its recording.
+*   @return  The hash of the current state.
+*/
+uint64_t BreakoutGame::stateHash()
+{
+	StateHash hash;
+	hash.add(ticks);
+	hash.add(score);
+	hash.add(lives);
+	hash.add(number_of_blocks);
+	hash.add(number_of_gems);
+	hash.add(gem_chance);
+	hash.add(paddle.get_vel_x());
+	hash.add(paddle_sprite->xPos());
+	hash.add(ball_sprite->xPos());
+	hash.add(ball_sprite->yPos());
+	hash.add(ball_direction.x);
+	hash.add(ball_direction.y);
+	hash.add(blocks.visible);
+	hash.add(gems.visible);
+	hash.add(gems.bounds.x);
+	hash.add(gems.bounds.y);
+	hash.add(extra_balls.bounds.x);
+	hash.add(extra_balls.bounds.y);
+	hash.add(extra_balls.vel_x);
+	hash.add(extra_balls.vel_y);
+	return hash.value();
+}
+
+/**
+*   @brief   Fast-forwards the session without rendering.
+*   @details Copies the ball, paddle and live bricks into an event
+			 driven simulation, which jumps from impact to impact
+			 rather than stepping frame by frame, then copies the
+			 results back. Bricks are scored and the ball respawned
+			 by the game as they happen, on the tick they would
+			 have happened in. Intended for headless use; gems and
+			 extra balls stand still while fast-forwarding. The
+			 ticks the time covers are counted as played.
+*   @param   seconds The amount of game time to skip.
+*   @return  The number of impacts simulated.
+*/
+size_t BreakoutGame::fastForward(double seconds)
+{
+	if (simulation)
+	{
+		simulation->wait();
+	}
+
+	if (!finishLoading())
+	{
+		return 0;
+	}
+
+	// the game respawns the ball and scores bricks itself, so its
+	// random numbers are drawn in the same order as when ticking
+	EventSimulation events(game_width, game_height, seed);
+	events.setTickLength(tick_ms / 1000);
+	events.setLives(lives);
+	events.setBall(ball.spriteComponent()->getBoundingBox(),
+		ball_direction, ball.speed);
+	events.setPaddle(paddle.spriteComponent()->getBoundingBox(),
+		paddle.get_vel_x() * paddle.speed);
+
+	auto first_tick = ticks;
+	events.onBrickDestroyed([this, first_tick](int brick, double time)
+	{
+		// scored as the tick the brick was hit in would score it
+		auto tick = std::max(1LL, static_cast<long long>(std::ceil(time * 1000 / tick_ms)));
+		tick_time.game_time = std::chrono::milliseconds(
+			static_cast<long long>((first_tick + tick) * tick_ms));
+
+		hideBrick(brick);
+		bricks_hit.push_back(brick);
+		collision(tick_time);
+	});
+	events.onRespawn([this](rect& bounds, vector2& direction)
+	{
+		respawn();
+		bounds = ball.spriteComponent()->getBoundingBox();
+		direction = ball_direction;
+	});
+
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		if (blocks.visible[i])
+		{
+			events.addBrick(static_cast<int>(i), blocks.boundingBox(i));
+		}
+	}
+
+	events.advance(seconds);
+
+	lives = events.lives();
+	ticks += std::llround(events.time() * 1000 / tick_ms);
+	tick_time.game_time = std::chrono::milliseconds(
+		static_cast<long long>(ticks * tick_ms));
+	ball_direction = events.ballDirection();
+	ball_sprite->xPos(events.ballBounds().x);
+	ball_sprite->yPos(events.ballBounds().y);
+	paddle_sprite->xPos(events.paddleBounds().x);
+	savePrevious();
+
+	// the paddle may have bounced off a wall while fast-forwarding
+	if (events.paddleVelocity() * paddle.get_vel_x() < 0)
+	{
+		paddle.set_vel_x(-paddle.get_vel_x());
+	}
+
+	return events.eventsProcessed();
+}
+
 // Handles spawning the ball
 void BreakoutGame::respawn()
 {
 
-	auto x = (rand() % 10 + 1) - 5;
-	auto y = (rand() % 1 - 10);
+	auto x = static_cast<int>(random() % 10 + 1) - 5;
+	auto y = static_cast<int>(random() % 1) - 10;
 
 	ball_direction.x = x;
 	ball_direction.y = y;
@@ -334,146 +1282,258 @@ void BreakoutGame::respawn()
 
 	ball_sprite->xPos((game_width - ball_sprite->width()) / 2);
 	ball_sprite->yPos(game_height - 80);
+	ball_previous.x = ball_sprite->xPos();
+	ball_previous.y = ball_sprite->yPos();
 
 }
 
 // Handles paddle movement
 void BreakoutGame::paddleMovement(float dt_sec)
 {
+	PROFILE_ZONE("paddleMovement");
 	auto paddle_pos = paddle_sprite->xPos();
 
 	if (paddle_sprite->xPos() <= 0)
 	{
 		paddle.set_vel_x(paddle.get_vel_x() * -1);
+		paddle_input_lead *= -1;
 	}
 	if (paddle_sprite->xPos() + paddle_sprite->width() >= game_width)
 	{
 		paddle.set_vel_x(paddle.get_vel_x() * -1);
+		paddle_input_lead *= -1;
 	}
 
-	paddle_pos += paddle.get_vel_x() * paddle.speed* dt_sec;
+	// keys may have changed the velocity part way into the tick
+	auto travel = paddle_input_lead + paddle.get_vel_x() * (1 - paddle_input_offset);
+	paddle_input_lead = 0;
+	paddle_input_offset = 0;
+
+	paddle_pos += travel * paddle.speed* dt_sec;
 
 	paddle_sprite->xPos(paddle_pos);
 }
 
-// Handles ball movement
+// Handles the movement of every ball
 void BreakoutGame::ballMovement(float dt_sec)
 {
-	auto ball_x_pos = ball_sprite->xPos();
-	auto ball_y_pos = ball_sprite->yPos();
+	PROFILE_ZONE("ballMovement");
+	paddle_box = paddle.spriteComponent()->getBoundingBox();
+
+	// the bottom of the play area is open, falling out loses a life
+	rect walls;
+	walls.length = game_width;
+	walls.height = std::numeric_limits<float>::max();
+
+	ball_box = ball.spriteComponent()->getBoundingBox();
+	auto fell = moveBall(ball_box, ball_direction, dt_sec, walls);
 
+	ball_sprite->xPos(ball_box.x);
+	ball_sprite->yPos(ball_box.y);
 
-	if (ball_box.isInside(paddle_box))
+	if (fell)
 	{
-		ball_y_pos -= 10;
-		ball_direction.y *= -1;
+		lives--;
+		respawn();
 	}
 
-	if (ball_x_pos + ball_sprite->width() >= game_width || ball_x_pos <= 0)
+	// the other balls rebound from the bottom too, so stay in play
+	walls.height = game_height;
+	for (size_t i = 0; i < extra_balls.size(); i++)
 	{
-		ball_direction.x *= -1;
+		auto box = extra_balls.boundingBox(i);
+		vector2 direction = { extra_balls.vel_x[i] / ball.speed, extra_balls.vel_y[i] / ball.speed };
+		moveBall(box, direction, dt_sec, walls);
+
+		extra_balls.bounds.x[i] = box.x;
+		extra_balls.bounds.y[i] = box.y;
+		extra_balls.vel_x[i] = direction.x * ball.speed;
+		extra_balls.vel_y[i] = direction.y * ball.speed;
 	}
+}
 
-	if (ball_y_pos <= 0)
+/**
+*   @brief   Moves a ball, resolving every impact along the way.
+*   @details Bricks the ball hits are hidden straight away and kept
+			 to be scored. The paddle's box must be up to date.
+*   @return  True if the ball reached the bottom of the screen.
+*/
+bool BreakoutGame::moveBall(rect& box, vector2& direction, float dt_sec, const rect& walls)
+{
+	// the paddle may have moved into the ball, push it back out on top
+	if (box.isInside(paddle_box) && direction.y > 0)
 	{
-		ball_direction.y *= -1;
+		box.y = paddle_box.y - box.height;
+		direction.y *= -1;
 	}
 
-	ball_x_pos += ball.speed * ball_direction.x * dt_sec;
-	ball_y_pos += ball.speed * ball_direction.y * dt_sec;
+	auto remaining = dt_sec;
+	for (int i = 0; i < max_ball_impacts && remaining > 0; i++)
+	{
+		auto delta = direction * (ball.speed * remaining);
 
+		auto impact = sweepBounds(box, delta, walls);
+		auto paddle_impact = sweepRect(box, delta, paddle_box);
+		if (paddle_impact.hit && paddle_impact.time <= impact.time)
+		{
+			impact = paddle_impact;
+		}
+
+		auto brick = sweepBricks(box, delta, impact);
 
-	ball_sprite->xPos(ball_x_pos);
-	ball_sprite->yPos(ball_y_pos);
+		box.x += delta.x * impact.time;
+		box.y += delta.y * impact.time;
 
-	if (ball_y_pos + ball_sprite->height() >= game_height)
+		if (!impact.hit)
+		{
+			break;
+		}
+
+		reflect(direction, impact.normal);
+		remaining -= remaining * impact.time;
+
+		if (brick >= 0)
+		{
+			// removed straight away so later impacts this step ignore it
+			hideBrick(brick);
+			bricks_hit.push_back(brick);
+		}
+	}
+
+	return box.y + box.height >= game_height;
+}
+
+/**
+*   @brief   Finds the first brick the ball hits during a move.
+*   @details Candidates come from the grid, are culled against the
+			 swept box in a single batch and the survivors are swept
+			 exactly. The impact is only replaced if a brick is hit
+			 no later than it. Ties go to the lowest numbered brick.
+*   @return  The index of the brick that was hit, or -1.
+*/
+int BreakoutGame::sweepBricks(const rect& box, const vector2& delta, SweepHit& impact)
+{
+	rect swept_box;
+	swept_box.x = std::min(box.x, box.x + delta.x);
+	swept_box.y = std::min(box.y, box.y + delta.y);
+	swept_box.length = box.length + std::abs(delta.x);
+	swept_box.height = box.height + std::abs(delta.y);
+
+	brick_grid.query(swept_box, brick_candidates);
+
+	brick_boxes.clear();
+	for (auto i : brick_candidates)
 	{
-		lives--;
-		respawn();
+		brick_boxes.push_back(blocks.boundingBox(i));
 	}
+	overlapMask(swept_box, brick_boxes, brick_hits);
 
+	int first = -1;
+	for (size_t j = 0; j < brick_candidates.size(); j++)
+	{
+		if (!isHit(brick_hits, j))
+		{
+			continue;
+		}
+
+		auto i = brick_candidates[j];
+		auto brick_impact = sweepRect(box, delta, brick_boxes[j]);
+		if (!brick_impact.hit || brick_impact.time > impact.time)
+		{
+			continue;
+		}
 
+		if (first < 0 || brick_impact.time < impact.time || i < first)
+		{
+			impact = brick_impact;
+			first = i;
+		}
+	}
 
+	return first;
 }
 
-// Handles all collisions
+// Scores the bricks the ball destroyed this frame
 void BreakoutGame::collision(const ASGE::GameTime& us)
 {
+	PROFILE_ZONE("collision");
 	ball_box = ball.spriteComponent()->getBoundingBox();
 	paddle_box = paddle.spriteComponent()->getBoundingBox();
-	auto dt_sec = us.delta_time.count() / 1000.0;
-	for (int i = 0; i <= block_array_size; i++)
+
+	for (size_t hit = 0; hit < bricks_hit.size(); hit++)
 	{
+		// at least 1, as the first bricks can fall within half a second
+		gem_chance += static_cast<int>(random() %
+			std::max<long long>(1, us.game_time.count() / 500));
 
-		block_box = blocks[i].spriteComponent()->getBoundingBox();
-		if (ball_box.isInside(block_box) && blocks[i].visibility == true)
+		if (number_of_gems > 0)
 		{
-			gem_chance += rand() % (us.game_time.count() / 500);
-
-			if (number_of_gems > 0)
+			if (gem_chance >= 50)
 			{
-				if (gem_chance >= 50)
-				{
-					gemSpawn();
-				}
+				gemSpawn();
 			}
-
-			ball_direction.y *= -1;
-			blocks[i].visibility = false;
-			score += 1000;
-			number_of_blocks--;
-			break;	
 		}
 
+		score += 1000;
+		number_of_blocks--;
 	}
+
+	bricks_hit.clear();
 }
 
 //Handles gem spawning
 void BreakoutGame::gemSpawn()
 {
-	
+	auto gem = number_of_gems - 1;
 
-	if(gems[number_of_gems-1].visibility == false)
-	{ 
-			gem_chance = 0;						
-			gem_sprite = gems[number_of_gems-1].spriteComponent()->getSprite();	
-			gem_sprite->xPos(((game_width - gem_sprite->width()) / 100) * (rand() % 100 + 1));
-			gem_sprite->yPos(-50);
-			gems[number_of_gems-1].visibility = true;
-			number_of_gems--;
-		
-	}		
+	if (!gems.visible[gem])
+	{
+		gem_chance = 0;
+		auto width = gems.bounds.length[gem];
+		gems.bounds.x[gem] = ((game_width - width) / 100) * (random() % 100 + 1);
+		gems.bounds.y[gem] = -50;
+		gem_previous.x[gem] = gems.bounds.x[gem];
+		gem_previous.y[gem] = gems.bounds.y[gem];
+		gems.vel_y[gem] = gem_speed;
+		gems.visible[gem] = true;
+		number_of_gems--;
+	}
 }
 
-//Handles gem movement and collision
-void BreakoutGame::gemMovement(float dt_sec)
+//Handles gem movement over a range of gems, which may run in parallel
+void BreakoutGame::gemMovement(size_t begin, size_t end)
 {
-	for (int i = 0; i < gem_array_size; i++)
+	PROFILE_ZONE("gemMovement");
+	for (size_t i = begin; i < end; i++)
 	{
-		if (gems[i].visibility == true)
+		gems_expired[i] = gems.visible[i] && gems.bounds.y[i] > game_height;
+		if (gems_expired[i])
 		{
-			if (gems[i].spriteComponent()->getSprite()->yPos() > game_height)
-			{
-				gems[i].visibility = false;
-				number_of_gems++;
-			}
-			gems[i].set_vel_y(1);
-
-			ASGE::Sprite* gem_sprite = gems[i].spriteComponent()->getSprite();
-			gem_box = gems[i].spriteComponent()->getBoundingBox();
-
-			auto gem_pos = gem_sprite->yPos();
+			gems.visible[i] = false;
+		}
+	}
 
-			gem_pos += gems[i].get_vel_y() * (gems[i].speed / 2) * dt_sec;
+	gems.integrate(tick_sec, begin, end);
+}
 
-			gem_sprite->yPos(gem_pos);
+//Counts the gems that expired, and handles catching gems
+void BreakoutGame::gemCatch()
+{
+	PROFILE_ZONE("gemCatch");
+	for (size_t i = 0; i < gems.size(); i++)
+	{
+		number_of_gems += gems_expired[i];
+	}
 
-			if (paddle_box.isInside(gem_box) && gems[i].visibility == true)
-			{
-				gems[i].visibility = false;
-				number_of_gems++;
-				score += 50000;
-			}
+	// test every gem against the paddle in one pass
+	overlapMask(paddle_box, gems.bounds, gem_hits);
+	for (size_t i = 0; i < gems.size(); i++)
+	{
+		if (isHit(gem_hits, i) && gems.visible[i])
+		{
+			gems.visible[i] = false;
+			number_of_gems++;
+			score += 50000;
 		}
 	}
 }
\ No newline at end of file
@@ -1,34 +1,207 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
 #include <string>
+#include <vector>
+
+#ifdef HEADLESS
+#include "Headless/HeadlessGame.h"
+using GameBase = HeadlessGame;
+#else
 #include <Engine/OGLGame.h>
+using GameBase = ASGE::OGLGame;
+#endif
+
+#include <Engine/InputEvents.h>
 
+#include "AssetArchive.h"
+#include "AssetLoader.h"
+#include "BrickGrid.h"
+#include "EntitySet.h"
+#include "EventQueue.h"
+#include "FrameStats.h"
 #include "GameObject.h"
+#include "Hud.h"
+#include "JobSystem.h"
 #include "Rect.h"
+#include "RectBatch.h"
+#include "RenderCommands.h"
+#include "Replay.h"
+#include "SceneGenerator.h"
+#include "StepThread.h"
+#include "Sweep.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include "TripleBuffer.h"
 
 
 /**
 *  An OpenGL Game based on ASGE.
+*  Headless builds run the same game on the NullRenderer instead.
 */
-class BreakoutGame :
-	public ASGE::OGLGame
+class BreakoutGame final :
+	public GameBase
 {
 public:
 	BreakoutGame();
 	~BreakoutGame();
 	virtual bool init() override;
 
-	void initGems();
+	bool initSprites();
+	bool initBlocks(SceneGenerator& generator);
+	void initBrickGrid();
+	bool initGems(SceneGenerator& generator);
+	bool initBalls(SceneGenerator& generator);
+	bool finishLoading();
+
+	/**
+	*  Skips play forward without ticking, jumping from impact to
+	*  impact. Paddle keys are not applied until it returns, and gems
+	*  and extra balls stand still.
+	*  @param [in] seconds The game time to skip.
+	*  @return the number of impacts simulated.
+	*/
+	size_t fastForward(double seconds);
+
+	/**
+	*  Chooses whether frames are simulated on their own thread, while
+	*  the previous frame is drawn. Only used with the texture atlas,
+	*  whose shared sprite is the only sprite touched when drawing.
+	*  Defaults to on when there is more than one hardware thread.
+	*  @param [in] enabled Whether to pipeline simulation and drawing.
+	*/
+	void setPipelined(bool enabled);
+
+	/**
+	*  Sets how often the simulation ticks. Play advances in ticks of a
+	*  fixed length, however often frames are drawn, and frames show
+	*  the game part way between the last two ticks. Defaults to 60.
+	*  @param [in] ticks_per_second The tick rate, in hertz.
+	*/
+	void setTickRate(double ticks_per_second);
+
+	/**
+	*  Seeds the game's random numbers. Must be called before init.
+	*  Defaults to the time the game was created.
+	*  @param [in] seed The seed.
+	*/
+	void setSeed(uint32_t seed);
+
+	/**
+	*  Sets the threads that share each tick's jobs, including the
+	*  thread that simulates. Must be called before init.
+	*  @param [in] thread_count The thread count, or 0 for one per
+	*  hardware thread.
+	*/
+	void setJobThreads(unsigned thread_count);
+
+	/**
+	*  Sets what the level is built from. Must be called before init.
+	*  Large or dense levels make stress scenes; extra balls rebound
+	*  from every wall, so they stay in play however long it lasts.
+	*  Defaults to the game's own level.
+	*  @param [in] settings The level's layout and counts.
+	*/
+	void setScene(const SceneSettings& settings);
+
+	/**
+	*  Records the session's inputs and the state after every tick.
+	*  Must be called before init, so the recording starts with play.
+	*/
+	void startRecording();
+
+	/**
+	*  Writes the session recorded since startRecording to a file.
+	*  @param [in] file_name The file to write.
+	*  @return true if the file was written.
+	*/
+	bool saveRecording(const std::string& file_name);
+
+	/**
+	*  Replays a recorded session as fast as possible, without drawing.
+	*  The game must have been seeded with the recording's seed and
+	*  have just finished loading. The recording's inputs are applied
+	*  on the ticks they were recorded on, and the state after each
+	*  tick is checked against the recording.
+	*  @param [in] session The recording to replay.
+	*  @return the first tick whose state differed, or -1 if none did.
+	*/
+	long long replay(const Replay& session);
+
+	/**
+	*  A summary of play, for tools that drive the game.
+	*/
+	struct Status
+	{
+		int score = 0;
+		int lives = 0;
+		int bricks_left = 0;
+		long long ticks = 0;    /**< Ticks simulated since play began. */
+		rect ball;              /**< The ball's bounds. */
+		rect paddle;            /**< The paddle's bounds. */
+		bool over = false;      /**< Whether the game was won or lost. */
+	};
+
+	/**
+	*  Returns the state of play, once the simulation has finished
+	*  any step in progress.
+	*  @return the current status.
+	*/
+	Status status();
+
+	/**
+	*  Returns the times of the most recent frames, once the
+	*  simulation has finished any step in progress.
+	*  @return the frame statistics.
+	*/
+	FrameStats& frameStats();
+
+	/**
+	*  Returns how long the game took to start, timed from when it was
+	*  made. Either is zero until that point has been reached.
+	*  @param [out] init_ms Set to when init returned, in milliseconds.
+	*  @param [out] ready_ms Set to when every asset had loaded.
+	*/
+	void startupTimes(double& init_ms, double& ready_ms) const;
+
+	/**
+	*  Returns how many key events were dropped because the key queue
+	*  was full. Dropped releases are still applied, see drainInput.
+	*  @return the dropped key event count.
+	*/
+	uint64_t droppedKeys() const;
 
 private:
 	void keyHandler(const ASGE::SharedEventData data);
 	void clickHandler(const ASGE::SharedEventData data);
 	void setupResolution();
+	void loadAssets();
 	void respawn();
 	void paddleMovement(float dt_sec);
 	void ballMovement(float dt_sec);
+	bool moveBall(rect& box, vector2& direction, float dt_sec, const rect& walls);
+	int  sweepBricks(const rect& box, const vector2& delta, SweepHit& impact);
 	void collision(const ASGE::GameTime & us);
 	void gemSpawn();
-	void gemMovement(float dt_sec);
+	void gemMovement(size_t begin, size_t end);
+	void gemCatch();
+	int  addEntitySprite(const std::string& frame_name);
+	void hideBrick(int brick);
+	void drainInput();
+	void applyInput(int step);
+	void handleKey(const ASGE::KeyEvent& key, float offset);
+	uint64_t stateHash();
+	void simulate();
+	void tick();
+	void buildTickGraph();
+	void savePrevious();
+	void sampleFrame(const ASGE::GameTime& us);
+	void recordFrame(RenderCommandList& commands);
+	void recordEntities(const EntitySet& entities, RenderCommandList& commands,
+		std::vector<SpriteCommand>* layer, const RectArray* previous = nullptr, float alpha = 1);
 
 	virtual void update(const ASGE::GameTime &) override;
 	virtual void render(const ASGE::GameTime &) override;
@@ -42,21 +215,38 @@ private:
 	int lives = 3;
 	float gem_time = 0;
 
+	//HUD counters
+	Hud hud;
+	int score_counter = -1;
+	int lives_counter = -1;
+	int gem_counter = -1;
+
+	//What the level is built from
+	SceneSettings scene;
 
 	//Block variables
-	int x_pos = 20;
-	int y_pos = 35;
-	int block_row = 1;
-	int block_array_size = 48;
-	int number_of_blocks = block_array_size;
+	int number_of_blocks = 0;
 
 	//Gem Variables
-	int gem_array_size = 3;
-	int number_of_gems = gem_array_size;
+	int number_of_gems = 0;
 	int gem_chance = 0;
+	float gem_speed = 150;
 
 	
 
+	//Shared textures, declared first so they outlive every user
+	AssetArchive archive;
+	std::unique_ptr<TextureCache> textures;
+	std::unique_ptr<TextureAtlas> atlas;
+
+	//Asset loading
+	std::unique_ptr<AssetLoader> loader;
+	std::vector<ASGE::Sprite*> preloaded;
+	bool assets_ready = false;
+	std::chrono::steady_clock::time_point startup_begin;
+	double startup_init_ms = 0;
+	double startup_ready_ms = 0;
+
 	//Add your GameObjects
 
 	//Paddle
@@ -69,13 +259,117 @@ private:
 	ASGE::Sprite* ball_sprite = nullptr;
 	rect ball_box;
 	vector2 ball_direction = { 2,3 };
+	int max_ball_impacts = 8;
+
+	//Balls other than the player's, with their velocities
+	EntitySet extra_balls;
+
+	//Sprites shared by the entity sets
+	std::vector<std::unique_ptr<SpriteComponent>> entity_sprites;
+
+	std::vector<SpriteCommand> entity_commands;
 
 	//Blocks
-	GameObject blocks[48];
-	ASGE::Sprite* block_sprite;
-	rect block_box;
+	EntitySet blocks;
+	BrickGrid brick_grid;
+	std::vector<int> brick_candidates;
+	RectArray brick_boxes;
+	std::vector<uint64_t> brick_hits;
+	std::vector<int> bricks_hit;
+
+	//Brick field, drawn as a static layer. Its sprites are recorded
+	//once and shared by every frame; bricks hidden since are named in
+	//each frame until a frame naming them has been drawn
+	struct LayerRemoval
+	{
+		long long frame = 0;    /**< The first frame recorded after it. */
+		int brick = 0;
+	};
+	rect brick_area;
+	std::shared_ptr<const std::vector<SpriteCommand>> brick_layer;
+	std::vector<LayerRemoval> brick_layer_removals;
 
 	//Gems
-	GameObject gems[3];
-	rect gem_box;
+	EntitySet gems;
+	std::vector<uint64_t> gem_hits;
+
+	//Key events, pushed by the callback from any thread and drained by
+	//the simulation, which applies each at its time within the step
+	struct KeyInput
+	{
+		ASGE::KeyEvent key;
+		std::chrono::steady_clock::time_point time;
+		int step = 0;       /**< The tick of the step it is applied before. */
+		float offset = 0;   /**< How far into that tick it took effect. */
+	};
+	static const size_t KEY_QUEUE_SIZE = 256;
+	EventQueue<KeyInput, KEY_QUEUE_SIZE> key_queue;
+	static const int NO_KEY = -1;
+	std::atomic<int> dropped_release{ NO_KEY };
+	std::atomic<long long> dropped_release_time{ 0 };
+	std::vector<KeyInput> step_keys;
+	size_t next_key = 0;
+	bool timed_input = true;
+	std::chrono::steady_clock::time_point last_step_time;
+
+	//Draw layers, drawn lowest first
+	enum DrawLayer : uint8_t
+	{
+		BACKGROUND_LAYER,
+		BRICK_LAYER,
+		GEM_LAYER,
+		PLAYER_LAYER,
+		HUD_LAYER
+	};
+
+	//Frames, recorded by the simulation and drawn by render
+	TripleBuffer<RenderCommandList> frames;
+	RenderCommandPlayer frame_player;
+	long long frames_recorded = 0;
+	std::atomic<long long> layer_frame_drawn{ -1 };
+	ASGE::GameTime step_time;
+	bool pipelined = false;
+	std::unique_ptr<StepThread> simulation;
+
+	//Fixed timestep, with the positions before the last tick kept
+	//so frames can be drawn between ticks
+	double tick_ms = 1000.0 / 60;
+	double tick_accumulator = 0;
+	int max_ticks_per_step = 8;
+	long long ticks = 0;
+	ASGE::GameTime tick_time;
+	float paddle_previous_x = 0;
+	vector2 ball_previous = { 0,0 };
+	RectArray gem_previous;
+	RectArray extra_ball_previous;
+
+	//Keys can change the paddle's velocity part way into a tick, so
+	//the tick's travel before the change is kept, in tick lengths at
+	//full speed, with how far into the tick the change came
+	float paddle_input_lead = 0;
+	float paddle_input_offset = 0;
+
+	//Jobs each tick is split into, run by the job system
+	static const size_t GEM_GRAIN = 1024;
+	std::unique_ptr<JobSystem> jobs;
+	JobGraph tick_graph;
+	unsigned job_threads = 0;
+	float tick_sec = 0;
+	std::vector<uint8_t> gems_expired;
+
+	//Random numbers, seeded so sessions can be replayed
+	uint32_t seed = 0;
+	std::minstd_rand random;
+
+	//Frame statistics, drawn over the game when toggled with F.
+	//The sample being taken is added once the frame's step is done
+	FrameStats frame_stats;
+	FrameStats::Sample frame_sample;
+	std::chrono::steady_clock::time_point frame_begin;
+	bool frame_sampled = false;
+	bool show_stats = false;
+
+	//Recording of the session, when enabled
+	Replay session_recording;
+	bool record_session = false;
 };
\ No newline at end of file
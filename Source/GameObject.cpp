@@ -1,4 +1,4 @@
-#include <Engine\Renderer.h>
+#include <Engine/Renderer.h>
 #include "GameObject.h"
 
 GameObject::~GameObject()
@@ -7,12 +7,27 @@ GameObject::~GameObject()
 }
 
 bool GameObject::addSpriteComponent(
-	ASGE::Renderer* renderer, const std::string& texture_file_name)
+	TextureCache& textures, const std::string& texture_file_name)
 {
 	freeSpriteComponent();
 
 	sprite_component = new SpriteComponent();
-	if (sprite_component->loadSprite(renderer, texture_file_name))
+	if (sprite_component->loadSprite(textures, texture_file_name))
+	{
+		return true;
+	}
+
+	freeSpriteComponent();
+	return false;
+}
+
+bool GameObject::addSpriteComponent(
+	TextureAtlas& atlas, const std::string& frame_name)
+{
+	freeSpriteComponent();
+
+	sprite_component = new SpriteComponent();
+	if (sprite_component->loadSprite(atlas, frame_name))
 	{
 		return true;
 	}
@@ -25,14 +25,23 @@ public:
 
 	/**
 	*  Allocates and attaches a sprite component to the object. 
-	*  Part of this process will attempt to load a texture file.
-	*  If this fails this function will return false and the memory
-	*  allocated, freed. 
-	*  @param [in] renderer The renderer used to perform the allocations
+	*  Part of this process will attempt to load a texture file,
+	*  unless the cache already holds it. If this fails this function
+	*  will return false and the memory allocated, freed. 
+	*  @param [in] textures The cache used to share loaded textures
 	*  @param [in] texture_file_name The file path to the the texture to load
 	*  @return true if the component is successfully added
 	*/
-	bool  addSpriteComponent(ASGE::Renderer* renderer, const std::string& texture_file_name);
+	bool  addSpriteComponent(TextureCache& textures, const std::string& texture_file_name);
+
+	/**
+	*  Allocates and attaches a sprite component showing an atlas frame.
+	*  Falls back to the frame's own image file if the atlas is missing.
+	*  @param [in] atlas The atlas holding the frame
+	*  @param [in] frame_name The image's file name without its extension
+	*  @return true if the component is successfully added
+	*/
+	bool  addSpriteComponent(TextureAtlas& atlas, const std::string& frame_name);
 	
 	/**
 	*  Returns the sprite componenent.
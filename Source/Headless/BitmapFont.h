@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+*  A built in 8x8 pixel font covering printable ASCII.
+*  Used by the software renderer, which cannot load font files. The
+*  glyphs are laid out in an atlas so text is drawn like any sprite.
+*/
+namespace BitmapFont
+{
+	const int GLYPH_SIZE = 8;
+	const int FIRST_CHAR = 32;
+	const int CHAR_COUNT = 95;
+	const int COLUMNS = 16;
+
+	/**
+	*  Builds the glyph atlas.
+	*  Glyphs are white, with an alpha of 255 where they are set,
+	*  so tinting the atlas colours the text.
+	*  @param [out] pixels RGBA pixels, as Blend expects them.
+	*  @param [out] width The width of the atlas.
+	*  @param [out] height The height of the atlas.
+	*/
+	void buildAtlas(std::vector<uint32_t>& pixels, int& width, int& height);
+
+	/**
+	*  Finds a character in the atlas.
+	*  Characters outside printable ASCII are drawn as '?'.
+	*  @param [in] c The character.
+	*  @param [out] x The left of its glyph in the atlas.
+	*  @param [out] y The top of its glyph in the atlas.
+	*/
+	void glyphPosition(char c, int& x, int& y);
+}
@@ -0,0 +1,274 @@
+#include <algorithm>
+
+#include "Blend.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BLEND_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 in functions marked for it,
+// MSVC emits any intrinsic it is given
+#if defined(BLEND_X86) && defined(__GNUC__)
+#define BLEND_AVX2 __attribute__((target("avx2")))
+#else
+#define BLEND_AVX2
+#endif
+
+namespace
+{
+	/**
+	*   @brief   Divides by 255, rounding to nearest.
+	*   @details Exact for every product of two bytes.
+	*/
+	inline uint32_t div255(uint32_t x)
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	void spanScalar(uint32_t* dst, const uint32_t* src, int count, const Blend::Tint& tint)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			uint32_t s = src[i];
+			uint32_t a = ((s >> 24) * tint.a) >> 8;
+			if (a == 0)
+			{
+				continue;
+			}
+
+			uint32_t d = dst[i];
+			uint32_t inv = 255 - a;
+			uint32_t r = ((s & 0xFF) * tint.r) >> 8;
+			uint32_t g = (((s >> 8) & 0xFF) * tint.g) >> 8;
+			uint32_t b = (((s >> 16) & 0xFF) * tint.b) >> 8;
+
+			r = div255(r * a + (d & 0xFF) * inv);
+			g = div255(g * a + ((d >> 8) & 0xFF) * inv);
+			b = div255(b * a + ((d >> 16) & 0xFF) * inv);
+			uint32_t out_a = div255(255 * a + (d >> 24) * inv);
+			dst[i] = r | (g << 8) | (b << 16) | (out_a << 24);
+		}
+	}
+
+#ifdef BLEND_X86
+
+	/**
+	*   @brief   Blends two pixels held as 16 bit lanes.
+	*   @details The source's alpha lane is replaced by 255 so the
+				 same sum composites the alpha channel.
+	*/
+	inline __m128i blendLanes(__m128i s, __m128i d, __m128i tint, __m128i alpha_mask)
+	{
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i half = _mm_set1_epi16(128);
+
+		s = _mm_srli_epi16(_mm_mullo_epi16(s, tint), 8);
+		__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)),
+			_MM_SHUFFLE(3, 3, 3, 3));
+		s = _mm_or_si128(s, alpha_mask);
+
+		__m128i x = _mm_add_epi16(_mm_mullo_epi16(s, a),
+			_mm_mullo_epi16(d, _mm_sub_epi16(full, a)));
+		x = _mm_add_epi16(x, half);
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	void spanSse2(uint32_t* dst, const uint32_t* src, int count, const Blend::Tint& tint)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i tints = _mm_setr_epi16(tint.r, tint.g, tint.b, tint.a,
+			tint.r, tint.g, tint.b, tint.a);
+		const __m128i alpha_mask = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(s, 24), zero)) == 0xFFFF)
+			{
+				continue;
+			}
+
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+			__m128i lo = blendLanes(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero),
+				tints, alpha_mask);
+			__m128i hi = blendLanes(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero),
+				tints, alpha_mask);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+		}
+
+		spanScalar(dst + i, src + i, count - i, tint);
+	}
+
+	BLEND_AVX2 inline __m256i blendLanes256(__m256i s, __m256i d, __m256i tint, __m256i alpha_mask)
+	{
+		const __m256i full = _mm256_set1_epi16(255);
+		const __m256i half = _mm256_set1_epi16(128);
+
+		s = _mm256_srli_epi16(_mm256_mullo_epi16(s, tint), 8);
+		__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)),
+			_MM_SHUFFLE(3, 3, 3, 3));
+		s = _mm256_or_si256(s, alpha_mask);
+
+		__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(s, a),
+			_mm256_mullo_epi16(d, _mm256_sub_epi16(full, a)));
+		x = _mm256_add_epi16(x, half);
+		return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+	}
+
+	BLEND_AVX2 void spanAvx2(uint32_t* dst, const uint32_t* src, int count, const Blend::Tint& tint)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i tints = _mm256_setr_epi16(tint.r, tint.g, tint.b, tint.a,
+			tint.r, tint.g, tint.b, tint.a, tint.r, tint.g, tint.b, tint.a,
+			tint.r, tint.g, tint.b, tint.a);
+		const __m256i alpha_mask = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255,
+			0, 0, 0, 255, 0, 0, 0, 255);
+
+		// unpacking and packing both work within 128 bit halves,
+		// so the pixels come back out in their original order
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			if (_mm256_testz_si256(s, _mm256_set1_epi32(static_cast<int>(0xFF000000u))))
+			{
+				continue;
+			}
+
+			__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+			__m256i lo = blendLanes256(_mm256_unpacklo_epi8(s, zero),
+				_mm256_unpacklo_epi8(d, zero), tints, alpha_mask);
+			__m256i hi = blendLanes256(_mm256_unpackhi_epi8(s, zero),
+				_mm256_unpackhi_epi8(d, zero), tints, alpha_mask);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+		}
+
+		spanSse2(dst + i, src + i, count - i, tint);
+	}
+
+	bool cpuHasAvx2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+
+		// the OS must save the AVX registers on a context switch
+		__cpuid(info, 1);
+		bool os_saves_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+			(_xgetbv(0) & 6) == 6;
+
+		__cpuidex(info, 7, 0);
+		return os_saves_avx && (info[1] & (1 << 5));
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+#endif
+
+	using SpanFnc = void(*)(uint32_t*, const uint32_t*, int, const Blend::Tint&);
+
+	Blend::Kernel bestKernel()
+	{
+#ifdef BLEND_X86
+		return cpuHasAvx2() ? Blend::Kernel::AVX2 : Blend::Kernel::SSE2;
+#else
+		return Blend::Kernel::SCALAR;
+#endif
+	}
+
+	SpanFnc spanFor(Blend::Kernel kernel)
+	{
+		switch (kernel)
+		{
+#ifdef BLEND_X86
+		case Blend::Kernel::AVX2:
+			return spanAvx2;
+		case Blend::Kernel::SSE2:
+			return spanSse2;
+#endif
+		default:
+			return spanScalar;
+		}
+	}
+
+	Blend::Kernel active_kernel = bestKernel();
+	SpanFnc active_span = spanFor(active_kernel);
+}
+
+Blend::Tint Blend::makeTint(float r, float g, float b, float a)
+{
+	auto convert = [](float value)
+	{
+		return static_cast<uint16_t>(std::min(std::max(value, 0.0f), 1.0f) * 256.0f + 0.5f);
+	};
+
+	Tint tint;
+	tint.r = convert(r);
+	tint.g = convert(g);
+	tint.b = convert(b);
+	tint.a = convert(a);
+	return tint;
+}
+
+bool Blend::supported(Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef BLEND_X86
+	case Kernel::AVX2:
+		return cpuHasAvx2();
+	case Kernel::SSE2:
+		return true;
+#endif
+	case Kernel::SCALAR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+Blend::Kernel Blend::kernel()
+{
+	return active_kernel;
+}
+
+bool Blend::setKernel(Kernel kernel)
+{
+	if (!supported(kernel))
+	{
+		return false;
+	}
+
+	active_kernel = kernel;
+	active_span = spanFor(kernel);
+	return true;
+}
+
+const char* Blend::name(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Kernel::AVX2:
+		return "avx2";
+	case Kernel::SSE2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
+
+void Blend::span(uint32_t* dst, const uint32_t* src, int count, const Tint& tint)
+{
+	active_span(dst, src, count, tint);
+}
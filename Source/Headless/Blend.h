@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+
+/**
+*  Alpha blending of 8 bit RGBA pixels.
+*  Pixels are stored as bytes in R, G, B, A order. Source pixels are
+*  tinted, then composited over the destination with the source's
+*  alpha. Scalar, SSE2 and AVX2 kernels give identical results; the
+*  fastest one the processor supports is chosen on first use.
+*/
+namespace Blend
+{
+	/**
+	*  Per channel multipliers, where 256 leaves a channel unchanged.
+	*/
+	struct Tint
+	{
+		uint16_t r = 256;
+		uint16_t g = 256;
+		uint16_t b = 256;
+		uint16_t a = 256;
+	};
+
+	enum class Kernel
+	{
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	/**
+	*  Converts colour and opacity in the range 0 to 1 to a tint.
+	*  @return the tint.
+	*/
+	Tint makeTint(float r, float g, float b, float a);
+
+	/**
+	*  Checks whether the processor can run a kernel.
+	*  @param [in] kernel The kernel to check.
+	*  @return true if it can be used.
+	*/
+	bool supported(Kernel kernel);
+
+	/**
+	*  Returns the kernel used by span.
+	*  @return the active kernel.
+	*/
+	Kernel kernel();
+
+	/**
+	*  Chooses the kernel used by span, for comparing them.
+	*  @param [in] kernel The kernel, which must be supported.
+	*  @return false if the kernel is not supported.
+	*/
+	bool setKernel(Kernel kernel);
+
+	/**
+	*  Returns a kernel's name.
+	*  @return the name.
+	*/
+	const char* name(Kernel kernel);
+
+	/**
+	*  Blends a row of source pixels over the destination.
+	*  @param [in,out] dst The destination pixels.
+	*  @param [in] src The source pixels, as many as the destination.
+	*  @param [in] count The number of pixels.
+	*  @param [in] tint The tint applied to every source pixel.
+	*/
+	void span(uint32_t* dst, const uint32_t* src, int count, const Tint& tint);
+}
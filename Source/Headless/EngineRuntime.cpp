@@ -0,0 +1,165 @@
+/**
+*  The engine's non-virtual layer, for headless builds.
+*  The ASGE library is only built for Windows with OpenGL, but most of
+*  what the game calls on Game, Renderer, Sprite and Input is plain
+*  state that the library implements outside any platform backend.
+*  This file provides those definitions so the game can be built and
+*  run with the NullRenderer on any platform, without the library.
+*  Builds that link the ASGE library must not compile this file.
+*/
+#include <chrono>
+
+#include <Engine/Game.h>
+#include <Engine/Input.h>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+namespace ASGE
+{
+	float Sprite::xPos() const { return position[0]; }
+	void  Sprite::xPos(float x) { position[0] = x; }
+	float Sprite::yPos() const { return position[1]; }
+	void  Sprite::yPos(float y) { position[1] = y; }
+	float Sprite::width() const { return dims[0]; }
+	void  Sprite::width(float width) { dims[0] = width; }
+	float Sprite::height() const { return dims[1]; }
+	void  Sprite::height(float height) { dims[1] = height; }
+	float Sprite::rotationInRadians() const { return angle; }
+	void  Sprite::rotationInRadians(float rotation_radians) { angle = rotation_radians; }
+	float Sprite::scale() const { return scale_factor; }
+	void  Sprite::scale(float scale_value) { scale_factor = scale_value; }
+	Colour Sprite::colour() const { return tint; }
+	void  Sprite::colour(ASGE::Colour sprite_colour) { tint = sprite_colour; }
+	bool  Sprite::isFlippedOnX() const { return (flip_flags & FLIP_X) != 0; }
+	bool  Sprite::isFlippedOnY() const { return (flip_flags & FLIP_Y) != 0; }
+	void  Sprite::setFlipFlags(FlipFlags flags) { flip_flags = flags; }
+	void  Sprite::opacity(float value) { alpha = value; }
+	float Sprite::opacity() const { return alpha; }
+	float* Sprite::srcRect() { return src_rect; }
+	const float* Sprite::srcRect() const { return src_rect; }
+
+	void Sprite::dimensions(float& width, float& height) const
+	{
+		width = dims[0];
+		height = dims[1];
+	}
+
+	Input::Input()
+	{
+
+	}
+
+	Input::~Input()
+	{
+		callback_funcs.clear();
+	}
+
+	/**
+	*   @brief   Sends an event to every callback registered for it.
+	*   @details Callbacks run on the calling thread whatever the
+				 value of use_threads, so headless runs are repeatable.
+	*   @return  void
+	*/
+	void Input::sendEvent(EventType type, SharedEventData data)
+	{
+		for (const auto& callback : callback_funcs)
+		{
+			if (callback.first == type && callback.second)
+			{
+				callback.second(data);
+			}
+		}
+	}
+
+	int Input::registerCallback(EventType type, InputFnc fnc)
+	{
+		callback_funcs.emplace_back(type, fnc);
+		return static_cast<int>(callback_funcs.size()) - 1;
+	}
+
+	void Input::unregisterCallback(unsigned int id)
+	{
+		// slots are cleared rather than erased, so other handles stay valid
+		if (id < callback_funcs.size())
+		{
+			callback_funcs[id].second = nullptr;
+		}
+	}
+
+	Renderer::RenderLib Renderer::getRenderLibrary()
+	{
+		return lib;
+	}
+
+	Renderer::WindowMode Renderer::getWindowMode()
+	{
+		return window_mode;
+	}
+
+	void Renderer::renderText(const std::string str, int x, int y, float scale, const Colour& colour)
+	{
+		renderText(str, x, y, scale, colour, 0.0f);
+	}
+
+	void Renderer::renderText(const std::string str, int x, int y, const Colour& colour)
+	{
+		renderText(str, x, y, 1.0f, colour, 0.0f);
+	}
+
+	void Renderer::renderText(const std::string str, int x, int y)
+	{
+		renderText(str, x, y, 1.0f, default_text_colour, 0.0f);
+	}
+
+	void Renderer::renderSprite(const Sprite& sprite)
+	{
+		renderSprite(sprite, 0.0f);
+	}
+
+	/**
+	*   @brief   The real time game loop.
+	*   @details Headless sessions normally step frames themselves, but
+				 run behaves as it does with the library.
+	*   @return  0 if the API shut down cleanly.
+	*/
+	int Game::run()
+	{
+		while (!exit)
+		{
+			auto now = std::chrono::steady_clock::now();
+			us.delta_time = now - us.frame_time;
+			us.frame_time = now;
+			us.game_time = getGameTime();
+
+			beginFrame();
+			update(us);
+			render(us);
+			endFrame();
+			updateFPS();
+		}
+
+		return exitAPI() ? 0 : -1;
+	}
+
+	void Game::signalExit()
+	{
+		exit = true;
+	}
+
+	void Game::toggleFPS()
+	{
+		show_fps = !show_fps;
+	}
+
+	void Game::updateFPS()
+	{
+		// there is no window to draw the counter in
+	}
+
+	std::chrono::milliseconds Game::getGameTime()
+	{
+		static const auto start = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start);
+	}
+}
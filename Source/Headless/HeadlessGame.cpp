@@ -0,0 +1,113 @@
+#include <Engine/InputEvents.h>
+#include <Engine/Keys.h>
+
+#include "HeadlessGame.h"
+#include "Profiler.h"
+
+void HeadlessGame::useBackend(Backend renderer_backend, int width, int height)
+{
+	backend = renderer_backend;
+	output_width = width;
+	output_height = height;
+}
+
+/**
+*   @brief   Creates the chosen renderer and its input.
+*   @return  True if both initialised.
+*/
+bool HeadlessGame::initAPI(ASGE::Renderer::WindowMode mode)
+{
+	if (backend == Backend::SOFTWARE)
+	{
+		software_renderer = new SoftwareRenderer();
+		software_renderer->setOutputSize(output_width, output_height);
+		null_renderer = software_renderer;
+	}
+	else
+	{
+		null_renderer = new NullRenderer();
+	}
+
+	renderer.reset(null_renderer);
+	if (!renderer->init(game_width, game_height, mode))
+	{
+		return false;
+	}
+
+	inputs = renderer->inputPtr();
+	return inputs->init(renderer.get());
+}
+
+bool HeadlessGame::exitAPI()
+{
+	return renderer->exit();
+}
+
+void HeadlessGame::beginFrame()
+{
+	PROFILE_ZONE("beginFrame");
+	inputs->update();
+	renderer->preRender();
+}
+
+void HeadlessGame::endFrame()
+{
+	PROFILE_ZONE("endFrame");
+	renderer->postRender();
+	renderer->swapBuffers();
+}
+
+/**
+*   @brief   Runs a fixed number of frames.
+*   @details The same sequence as Game::run, but game time advances
+			 by frame_ms each frame instead of following the clock.
+*   @return  The number of frames completed.
+*/
+int HeadlessGame::runFrames(int frame_count, double frame_ms)
+{
+	frame_time.delta_time = std::chrono::duration<double, std::milli>(frame_ms);
+
+	int frames = 0;
+	double elapsed_ms = static_cast<double>(frame_time.game_time.count());
+	while (frames < frame_count && !exit)
+	{
+		elapsed_ms += frame_ms;
+		frame_time.game_time = std::chrono::milliseconds(
+			static_cast<long long>(elapsed_ms));
+		frame_time.frame_time = std::chrono::steady_clock::now();
+
+		beginFrame();
+		update(frame_time);
+		render(frame_time);
+		endFrame();
+		frames++;
+	}
+
+	return frames;
+}
+
+void HeadlessGame::tapKey(int key)
+{
+	sendKey(key, ASGE::KEYS::KEY_PRESSED);
+	sendKey(key, ASGE::KEYS::KEY_RELEASED);
+}
+
+void HeadlessGame::sendKey(int key, int action)
+{
+	auto event = std::make_shared<ASGE::KeyEvent>();
+	event->key = key;
+	event->scancode = 0;
+	event->action = action;
+	event->mods = 0;
+	inputs->sendEvent(ASGE::E_KEY, event);
+}
+
+const NullRenderer::Stats& HeadlessGame::stats() const
+{
+	return null_renderer->totals();
+}
+
+SoftwareRenderer* HeadlessGame::softwareRenderer() const
+{
+	return software_renderer;
+}
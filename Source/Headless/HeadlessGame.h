@@ -0,0 +1,89 @@
+#pragma once
+#include <Engine/Game.h>
+
+#include "NullRenderer.h"
+#include "SoftwareRenderer.h"
+
+/**
+*  A Game that runs without a window.
+*  Uses the NullRenderer by default, so the full update and render
+*  path runs and is counted, but nothing is drawn. The
+*  SoftwareRenderer can be chosen instead to draw real pixels. Frames are stepped with a fixed
+*  delta rather than the clock, so a session is repeatable and runs as
+*  fast as the machine allows.
+*/
+class HeadlessGame : public ASGE::Game
+{
+public:
+
+	/**
+	*  The renderers a headless game can use.
+	*/
+	enum class Backend
+	{
+		NULL_RENDERER, /**< Counts draws without drawing. */
+		SOFTWARE       /**< Rasterizes into a framebuffer on the CPU. */
+	};
+
+	/**
+	*  Chooses the renderer. Must be called before the game is
+	*  initialised.
+	*  @param [in] backend The renderer to create.
+	*  @param [in] output_width The software framebuffer's width, or 0
+	*  for the game's design width.
+	*  @param [in] output_height The software framebuffer's height, or 0
+	*  for the game's design height.
+	*/
+	void useBackend(Backend backend, int output_width = 0, int output_height = 0);
+
+	virtual bool initAPI(ASGE::Renderer::WindowMode mode =
+		ASGE::Renderer::WindowMode::WINDOWED) override;
+	virtual bool exitAPI() override;
+	virtual void beginFrame() override;
+	virtual void endFrame() override;
+
+	/**
+	*  Runs the game loop for a number of frames.
+	*  Each frame advances game time by exactly frame_ms, however
+	*  long it took to process. Stops early if the game signals exit.
+	*  @param [in] frame_count The number of frames to run.
+	*  @param [in] frame_ms The simulated length of each frame.
+	*  @return the number of frames that ran.
+	*/
+	int runFrames(int frame_count, double frame_ms);
+
+	/**
+	*  Presses and releases a key, as if typed.
+	*  The events are sent through the input system, so they reach
+	*  the game's registered callbacks.
+	*  @param [in] key The key, from ASGE::KEYS.
+	*/
+	void tapKey(int key);
+
+	/**
+	*  Sends a single key event.
+	*  @param [in] key The key, from ASGE::KEYS.
+	*  @param [in] action KEY_PRESSED or KEY_RELEASED.
+	*/
+	void sendKey(int key, int action);
+
+	/**
+	*  Returns the renderer's counters since start up.
+	*  @return the running totals.
+	*/
+	const NullRenderer::Stats& stats() const;
+
+	/**
+	*  Returns the software renderer, when it is in use.
+	*  @return the renderer, or nullptr for the null backend.
+	*/
+	SoftwareRenderer* softwareRenderer() const;
+
+private:
+	ASGE::GameTime frame_time;
+	NullRenderer* null_renderer = nullptr;
+	SoftwareRenderer* software_renderer = nullptr;
+	Backend backend = Backend::NULL_RENDERER;
+	int output_width = 0;
+	int output_height = 0;
+};
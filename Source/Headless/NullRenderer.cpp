@@ -0,0 +1,330 @@
+#include <algorithm>
+
+#include "NullRenderer.h"
+#include "Png.h"
+
+NullTexture::NullTexture(int width, int height) : ASGE::Texture2D(width, height)
+{
+	format = RGBA;
+}
+
+void NullTexture::setData(void*)
+{
+
+}
+
+void* NullTexture::getData()
+{
+	return nullptr;
+}
+
+NullSprite::NullSprite()
+{
+	setFlipFlags(NORMAL);
+}
+
+/**
+*   @brief   Loads a texture's size.
+*   @details Only the PNG header is read. Separators are converted
+			 so the game's Windows style paths work everywhere.
+*   @return  True if the file is a readable PNG.
+*/
+bool NullSprite::loadTexture(const std::string& file_name)
+{
+	auto path = file_name;
+	std::replace(path.begin(), path.end(), '\\', '/');
+
+	int image_width = 0, image_height = 0;
+	if (!Png::dimensions(path, image_width, image_height))
+	{
+		return false;
+	}
+
+	setTexture(image_width, image_height);
+	return true;
+}
+
+bool NullSprite::loadTextureFromMemory(const void*, int image_width, int image_height)
+{
+	setTexture(image_width, image_height);
+	return true;
+}
+
+const ASGE::Texture2D* NullSprite::getTexture() const
+{
+	return texture.get();
+}
+
+void NullSprite::setTexture(int image_width, int image_height)
+{
+	texture.reset(new NullTexture(image_width, image_height));
+	width(static_cast<float>(image_width));
+	height(static_cast<float>(image_height));
+
+	auto source = srcRect();
+	source[0] = 0;
+	source[1] = 0;
+	source[2] = static_cast<float>(image_width);
+	source[3] = static_cast<float>(image_height);
+}
+
+bool NullInput::init(ASGE::Renderer*)
+{
+	return true;
+}
+
+void NullInput::update()
+{
+
+}
+
+void NullInput::getCursorPos(double& xpos, double& ypos) const
+{
+	xpos = cursor_x;
+	ypos = cursor_y;
+}
+
+const GamePadData NullInput::getGamePad(int idx) const
+{
+	return GamePadData(idx, "", 0, nullptr, 0, nullptr);
+}
+
+void NullInput::setCursorPos(double xpos, double ypos)
+{
+	cursor_x = xpos;
+	cursor_y = ypos;
+}
+
+NullRenderer::NullRenderer() : ASGE::Renderer(RenderLib::INVALID)
+{
+	// font 0 is the default font, as with the OpenGL renderer
+	fonts.emplace_back();
+	fonts.back().font_name = "default";
+	fonts.back().font_size = 16;
+	fonts.back().line_height = 16;
+}
+
+void NullRenderer::setClearColour(ASGE::Colour rgb)
+{
+	cls = rgb;
+}
+
+int NullRenderer::loadFont(const char* font, int pt)
+{
+	// the caller's string may not outlive the font
+	font_names.emplace_back(font);
+	fonts.emplace_back();
+	fonts.back().font_name = font_names.back().c_str();
+	fonts.back().font_size = pt;
+	fonts.back().line_height = pt;
+	return static_cast<int>(fonts.size()) - 1;
+}
+
+bool NullRenderer::init(int w, int h, WindowMode mode)
+{
+	width = w;
+	height = h;
+	window_mode = mode;
+	total = Stats();
+	return true;
+}
+
+bool NullRenderer::exit()
+{
+	return true;
+}
+
+void NullRenderer::preRender()
+{
+	current = Stats();
+	frame_textures.clear();
+	last_texture = nullptr;
+}
+
+/**
+*   @brief   Completes the frame's counts.
+*   @details Sorting modes batch every use of a texture together,
+			 so they need one draw call per distinct texture.
+*   @return  void
+*/
+void NullRenderer::postRender()
+{
+	if (!frame_textures.empty())
+	{
+		std::sort(frame_textures.begin(), frame_textures.end());
+		current.draw_calls += std::unique(frame_textures.begin(), frame_textures.end()) -
+			frame_textures.begin();
+	}
+
+	current.frames = 1;
+	last = current;
+
+	total.frames++;
+	total.draw_calls += current.draw_calls;
+	total.sprites += current.sprites;
+	total.text_calls += current.text_calls;
+}
+
+void NullRenderer::renderText(const std::string str, int x, int y, float scale,
+	const ASGE::Colour& colour, float z_order)
+{
+	renderText(str.data(), str.size(), x, y, scale, colour, z_order);
+}
+
+void NullRenderer::renderText(const char*, size_t, int, int, float,
+	const ASGE::Colour&, float)
+{
+	current.text_calls++;
+	submit(&fonts[active_font]);
+}
+
+void NullRenderer::setDefaultTextColour(const ASGE::Colour& colour)
+{
+	default_text_colour = colour;
+}
+
+const ASGE::Font& NullRenderer::getActiveFont() const
+{
+	return fonts[active_font];
+}
+
+void NullRenderer::setFont(int id)
+{
+	if (id >= 0 && id < static_cast<int>(fonts.size()))
+	{
+		active_font = id;
+	}
+}
+
+void NullRenderer::renderSprite(const ASGE::Sprite& sprite, float)
+{
+	current.sprites++;
+	submit(sprite.getTexture());
+}
+
+void NullRenderer::renderSprites(const ASGE::Sprite& sprite,
+	const SpriteInstance*, size_t count)
+{
+	current.sprites += count;
+	submit(sprite.getTexture());
+}
+
+void NullRenderer::setSpriteMode(ASGE::SpriteSortMode mode)
+{
+	sort_mode = mode;
+}
+
+/**
+*   @brief   Creates a layer.
+*   @details Layers hold nothing here, but are tracked so their
+			 handles behave as they would in a drawing renderer.
+*   @return  The layer's handle.
+*/
+int NullRenderer::createLayer(const rect& area)
+{
+	for (size_t i = 0; i < layers.size(); i++)
+	{
+		if (!layers[i])
+		{
+			layers[i].reset(new rect(area));
+			return static_cast<int>(i);
+		}
+	}
+
+	layers.emplace_back(new rect(area));
+	return static_cast<int>(layers.size()) - 1;
+}
+
+void NullRenderer::destroyLayer(int layer)
+{
+	if (layer >= 0 && layer < static_cast<int>(layers.size()))
+	{
+		layers[layer].reset();
+	}
+}
+
+void NullRenderer::beginLayer(int, const rect&)
+{
+
+}
+
+void NullRenderer::endLayer()
+{
+
+}
+
+void NullRenderer::renderLayer(int layer)
+{
+	if (layer >= 0 && layer < static_cast<int>(layers.size()) && layers[layer])
+	{
+		submit(layers[layer].get());
+	}
+}
+
+void NullRenderer::setWindowedMode(WindowMode mode)
+{
+	window_mode = mode;
+}
+
+void NullRenderer::setWindowTitle(const char*)
+{
+
+}
+
+void NullRenderer::swapBuffers()
+{
+
+}
+
+std::unique_ptr<ASGE::Input> NullRenderer::inputPtr()
+{
+	return std::unique_ptr<ASGE::Input>(new NullInput());
+}
+
+std::unique_ptr<ASGE::Sprite> NullRenderer::createUniqueSprite()
+{
+	return std::unique_ptr<ASGE::Sprite>(new NullSprite());
+}
+
+ASGE::Sprite* NullRenderer::createRawSprite()
+{
+	return new NullSprite();
+}
+
+const NullRenderer::Stats& NullRenderer::lastFrame() const
+{
+	return last;
+}
+
+const NullRenderer::Stats& NullRenderer::totals() const
+{
+	return total;
+}
+
+void NullRenderer::resolution(int& w, int& h) const
+{
+	w = width;
+	h = height;
+}
+
+void NullRenderer::submit(const void* texture)
+{
+	switch (sort_mode)
+	{
+	case ASGE::SpriteSortMode::IMMEDIATE:
+		current.draw_calls++;
+		break;
+
+	case ASGE::SpriteSortMode::DEFERRED:
+		if (texture != last_texture || current.draw_calls == 0)
+		{
+			current.draw_calls++;
+			last_texture = texture;
+		}
+		break;
+
+	default:
+		frame_textures.push_back(texture);
+		break;
+	}
+}
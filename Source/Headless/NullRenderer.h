@@ -0,0 +1,171 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Engine/Font.h>
+#include <Engine/Input.h>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+#include <Engine/Texture.h>
+
+#include "BatchRenderer.h"
+#include "LayerRenderer.h"
+#include "MemoryTextureSprite.h"
+#include "TextRenderer.h"
+
+/**
+*  A texture that only records its size and format.
+*  No pixels are kept, which is all a renderer that draws nothing needs.
+*/
+class NullTexture : public ASGE::Texture2D
+{
+public:
+	NullTexture(int width, int height);
+
+	void  setData(void* data) override;
+	void* getData() override;
+};
+
+/**
+*  A sprite for the null renderer.
+*  Loading a texture only reads the image's header for its size, so
+*  sprites have the dimensions the game expects without decoding.
+*/
+class NullSprite : public ASGE::Sprite, public MemoryTextureSprite
+{
+public:
+	NullSprite();
+
+	bool loadTexture(const std::string& file_name) override;
+	bool loadTextureFromMemory(const void* pixels, int width, int height) override;
+	const ASGE::Texture2D* getTexture() const override;
+
+private:
+	void setTexture(int width, int height);
+	std::unique_ptr<NullTexture> texture;
+};
+
+/**
+*  Input for the null renderer.
+*  There are no devices, but events can still be injected through
+*  sendEvent, which is how headless sessions drive the game.
+*/
+class NullInput : public ASGE::Input
+{
+public:
+	bool init(ASGE::Renderer* renderer) override;
+	void update() override;
+	void getCursorPos(double& xpos, double& ypos) const override;
+	const GamePadData getGamePad(int idx) const override;
+
+	/**
+	*  Moves the virtual cursor.
+	*  @param [in] xpos The new position on the x axis.
+	*  @param [in] ypos The new position on the y axis.
+	*/
+	void setCursorPos(double xpos, double ypos);
+
+private:
+	double cursor_x = 0;
+	double cursor_y = 0;
+};
+
+/**
+*  A renderer that draws nothing.
+*  Every call is accepted and counted, so games can run without a
+*  window or GPU, and the counts show how a frame would be drawn.
+*  Draw calls are counted as a batching renderer would issue them
+*  for the current SpriteSortMode: one per sprite when immediate,
+*  one per change of texture when deferred, and one per distinct
+*  texture when sorting. A renderSprites batch counts as a single
+*  instanced draw, as does rendering a layer.
+*/
+class NullRenderer : public ASGE::Renderer, public BatchRenderer,
+	public LayerRenderer, public TextRenderer
+{
+public:
+
+	/**
+	*  Counters, kept for the last frame and since start up.
+	*/
+	struct Stats
+	{
+		size_t frames = 0;     /**< Frames completed. */
+		size_t draw_calls = 0; /**< Batches a GPU renderer would submit. */
+		size_t sprites = 0;    /**< Sprites submitted. */
+		size_t text_calls = 0; /**< Strings submitted. */
+	};
+
+	NullRenderer();
+	~NullRenderer() override = default;
+
+	void setClearColour(ASGE::Colour rgb) override;
+	int  loadFont(const char* font, int pt) override;
+	bool init(int w, int h, WindowMode mode) override;
+	bool exit() override;
+	void preRender() override;
+	void postRender() override;
+	void renderText(const std::string str, int x, int y, float scale,
+		const ASGE::Colour& colour, float z_order) override;
+	void renderText(const char* text, size_t length, int x, int y, float scale,
+		const ASGE::Colour& colour, float z_order) override;
+	void setDefaultTextColour(const ASGE::Colour& colour) override;
+	const ASGE::Font& getActiveFont() const override;
+	void setFont(int id) override;
+	void renderSprite(const ASGE::Sprite& sprite, float z_order) override;
+	void renderSprites(const ASGE::Sprite& sprite,
+		const SpriteInstance* instances, size_t count) override;
+	void setSpriteMode(ASGE::SpriteSortMode mode) override;
+	int  createLayer(const rect& area) override;
+	void destroyLayer(int layer) override;
+	void beginLayer(int layer, const rect& region) override;
+	void endLayer() override;
+	void renderLayer(int layer) override;
+	void setWindowedMode(WindowMode mode) override;
+	void setWindowTitle(const char* str) override;
+	void swapBuffers() override;
+	std::unique_ptr<ASGE::Input> inputPtr() override;
+	std::unique_ptr<ASGE::Sprite> createUniqueSprite() override;
+	ASGE::Sprite* createRawSprite() override;
+
+	using ASGE::Renderer::renderSprite;
+	using ASGE::Renderer::renderText;
+
+	/**
+	*  Returns the counts for the last completed frame.
+	*  @return the last frame's counters.
+	*/
+	const Stats& lastFrame() const;
+
+	/**
+	*  Returns the counts since the renderer was initialised.
+	*  @return the running totals.
+	*/
+	const Stats& totals() const;
+
+	/**
+	*  Returns the size the renderer was initialised with.
+	*  @param [out] w The width in pixels.
+	*  @param [out] h The height in pixels.
+	*/
+	void resolution(int& w, int& h) const;
+
+private:
+	void submit(const void* texture);
+
+	ASGE::SpriteSortMode sort_mode = ASGE::SpriteSortMode::IMMEDIATE;
+	std::vector<const void*> frame_textures;
+	const void* last_texture = nullptr;
+	std::deque<ASGE::Font> fonts;
+	std::deque<std::string> font_names;
+	std::vector<std::unique_ptr<rect>> layers;
+	int active_font = 0;
+	int width = 0;
+	int height = 0;
+	Stats current;
+	Stats last;
+	Stats total;
+};
@@ -0,0 +1,802 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "BitmapFont.h"
+#include "Png.h"
+#include "Profiler.h"
+#include "SoftwareRenderer.h"
+
+namespace
+{
+	// truncation that rounds down for the small negative values
+	// found at the edges of a quad, without calling floor
+	inline int floorToInt(float value)
+	{
+		return static_cast<int>(value + 65536.0f) - 65536;
+	}
+
+	// draws smaller than this are rasterized on the calling thread
+	const int SERIAL_AREA = 128 * 128;
+}
+
+SoftwareTexture::SoftwareTexture(int width, int height, std::vector<uint32_t> pixels)
+	: ASGE::Texture2D(width, height), owned(std::move(pixels))
+{
+	format = RGBA;
+	this->pixels = owned.data();
+}
+
+SoftwareTexture::SoftwareTexture(int width, int height, const uint32_t* borrowed_pixels)
+	: ASGE::Texture2D(width, height), pixels(borrowed_pixels)
+{
+	format = RGBA;
+}
+
+/**
+*   @brief   Replaces the texture's pixels.
+*   @details The data is copied, and must hold width * height RGBA
+			 pixels.
+*   @return  void
+*/
+void SoftwareTexture::setData(void* data)
+{
+	owned.resize(static_cast<size_t>(dims[0]) * dims[1]);
+	std::memcpy(owned.data(), data, owned.size() * sizeof(uint32_t));
+	pixels = owned.data();
+}
+
+void* SoftwareTexture::getData()
+{
+	return const_cast<uint32_t*>(pixels);
+}
+
+const uint32_t* SoftwareTexture::texels() const
+{
+	return pixels;
+}
+
+SoftwareSprite::SoftwareSprite()
+{
+	setFlipFlags(NORMAL);
+}
+
+/**
+*   @brief   Loads and decodes a PNG.
+*   @details Separators are converted so the game's Windows style
+			 paths work everywhere.
+*   @return  True if the image was decoded.
+*/
+bool SoftwareSprite::loadTexture(const std::string& file_name)
+{
+	auto path = file_name;
+	std::replace(path.begin(), path.end(), '\\', '/');
+
+	Png::Image image;
+	if (!Png::load(path, image))
+	{
+		return false;
+	}
+
+	// RGBA bytes read as little endian words, the layout Blend uses
+	std::vector<uint32_t> pixels(static_cast<size_t>(image.width) * image.height);
+	std::memcpy(pixels.data(), image.pixels.data(), pixels.size() * sizeof(uint32_t));
+	setTexture(std::unique_ptr<SoftwareTexture>(
+		new SoftwareTexture(image.width, image.height, std::move(pixels))));
+	return true;
+}
+
+bool SoftwareSprite::loadTextureFromMemory(const void* pixels, int image_width, int image_height)
+{
+	setTexture(std::unique_ptr<SoftwareTexture>(new SoftwareTexture(
+		image_width, image_height, static_cast<const uint32_t*>(pixels))));
+	return true;
+}
+
+const ASGE::Texture2D* SoftwareSprite::getTexture() const
+{
+	return texture.get();
+}
+
+void SoftwareSprite::setTexture(std::unique_ptr<SoftwareTexture> new_texture)
+{
+	texture = std::move(new_texture);
+	width(static_cast<float>(texture->getWidth()));
+	height(static_cast<float>(texture->getHeight()));
+
+	auto source = srcRect();
+	source[0] = 0;
+	source[1] = 0;
+	source[2] = static_cast<float>(texture->getWidth());
+	source[3] = static_cast<float>(texture->getHeight());
+}
+
+/**
+*   @brief   Constructor.
+*   @details Starts the rasterizing threads, which wait for work.
+*/
+SoftwareRenderer::SoftwareRenderer(unsigned threads)
+{
+	thread_count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+	row_buffers.resize(thread_count);
+	for (unsigned i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(&SoftwareRenderer::workerLoop, this, i);
+	}
+
+	std::vector<uint32_t> glyphs;
+	int atlas_width = 0, atlas_height = 0;
+	BitmapFont::buildAtlas(glyphs, atlas_width, atlas_height);
+	font_texture.reset(new SoftwareTexture(atlas_width, atlas_height, std::move(glyphs)));
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+	{
+		std::lock_guard<std::mutex> lock(work_mutex);
+		stopping = true;
+	}
+	work_ready.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void SoftwareRenderer::setOutputSize(int width, int height)
+{
+	output_width = width;
+	output_height = height;
+}
+
+/**
+*   @brief   Creates the framebuffer.
+*   @details The design resolution is scaled uniformly to fit the
+			 output size and centred within it.
+*   @return  True if the framebuffer is usable.
+*/
+bool SoftwareRenderer::init(int w, int h, WindowMode window)
+{
+	if (w <= 0 || h <= 0 || !NullRenderer::init(w, h, window))
+	{
+		return false;
+	}
+
+	frame_width = output_width > 0 ? output_width : w;
+	frame_height = output_height > 0 ? output_height : h;
+	view_scale = std::min(float(frame_width) / w, float(frame_height) / h);
+	view_x = (frame_width - w * view_scale) / 2;
+	view_y = (frame_height - h * view_scale) / 2;
+	framebuffer.assign(static_cast<size_t>(frame_width) * frame_height, 0);
+	targetFramebuffer();
+
+	tiles_x = (frame_width + TILE_SIZE - 1) / TILE_SIZE;
+	tiles_y = (frame_height + TILE_SIZE - 1) / TILE_SIZE;
+	tile_count = tiles_x * tiles_y;
+	tile_quads.assign(tile_count, std::vector<uint32_t>());
+	for (auto& row : row_buffers)
+	{
+		row.assign(TILE_SIZE, 0);
+	}
+
+	return true;
+}
+
+bool SoftwareRenderer::exit()
+{
+	quads.clear();
+	layer_buffers.clear();
+	return NullRenderer::exit();
+}
+
+/**
+*   @brief   Starts a frame.
+*   @details The clear is done by the tiles on their first flush,
+			 so it is spread across the threads too.
+*   @return  void
+*/
+void SoftwareRenderer::preRender()
+{
+	NullRenderer::preRender();
+
+	auto channel = [](float value)
+	{
+		return static_cast<uint32_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	};
+	clear_colour = channel(cls.r) | (channel(cls.g) << 8) | (channel(cls.b) << 16) | 0xFF000000u;
+	clear_pending = true;
+}
+
+void SoftwareRenderer::postRender()
+{
+	flush();
+	NullRenderer::postRender();
+}
+
+/**
+*   @brief   Draws text with the built in font.
+*   @details The active font's size scales the 8 pixel glyphs, and
+			 y is the text's baseline. Each character is drawn as a
+			 quad from the glyph atlas.
+*   @return  void
+*/
+void SoftwareRenderer::renderText(const char* text, size_t length, int x, int y,
+	float scale, const ASGE::Colour& colour, float z_order)
+{
+	NullRenderer::renderText(text, length, x, y, scale, colour, z_order);
+
+	const auto& font = getActiveFont();
+	float glyph = (font.font_size > 0 ? font.font_size : BitmapFont::GLYPH_SIZE) * scale;
+	float line = (font.line_height > 0 ? font.line_height : glyph) * scale;
+	auto tint = Blend::makeTint(colour.r, colour.g, colour.b, 1.0f);
+
+	float pen_x = static_cast<float>(x);
+	float pen_y = y - glyph;
+	for (size_t i = 0; i < length; i++)
+	{
+		auto c = text[i];
+		if (c == '\n')
+		{
+			pen_x = static_cast<float>(x);
+			pen_y += line;
+			continue;
+		}
+
+		if (c != ' ')
+		{
+			int glyph_x = 0, glyph_y = 0;
+			BitmapFont::glyphPosition(c, glyph_x, glyph_y);
+			const float src[4] = { float(glyph_x), float(glyph_y),
+				float(BitmapFont::GLYPH_SIZE), float(BitmapFont::GLYPH_SIZE) };
+			queue(font_texture.get(), pen_x, pen_y, glyph, glyph, 0, src,
+				false, false, tint, z_order);
+		}
+
+		pen_x += glyph;
+	}
+
+	if (mode == ASGE::SpriteSortMode::IMMEDIATE)
+	{
+		flush();
+	}
+}
+
+void SoftwareRenderer::renderSprite(const ASGE::Sprite& sprite, float z_order)
+{
+	NullRenderer::renderSprite(sprite, z_order);
+
+	auto texture = dynamic_cast<const SoftwareTexture*>(sprite.getTexture());
+	if (!texture)
+	{
+		return;
+	}
+
+	auto tint_colour = sprite.colour();
+	auto tint = Blend::makeTint(tint_colour.r, tint_colour.g, tint_colour.b, sprite.opacity());
+	queue(texture, sprite.xPos(), sprite.yPos(), sprite.width() * sprite.scale(),
+		sprite.height() * sprite.scale(), sprite.rotationInRadians(), sprite.srcRect(),
+		sprite.isFlippedOnX(), sprite.isFlippedOnY(), tint, z_order);
+
+	if (mode == ASGE::SpriteSortMode::IMMEDIATE)
+	{
+		flush();
+	}
+}
+
+/**
+*   @brief   Queues a batch of instances.
+*   @details The texture and transform state are read from the sprite
+			 once, rather than once per instance.
+*   @return  void
+*/
+void SoftwareRenderer::renderSprites(const ASGE::Sprite& sprite,
+	const SpriteInstance* instances, size_t count)
+{
+	NullRenderer::renderSprites(sprite, instances, count);
+
+	auto texture = dynamic_cast<const SoftwareTexture*>(sprite.getTexture());
+	if (!texture)
+	{
+		return;
+	}
+
+	float scale = sprite.scale();
+	float angle = sprite.rotationInRadians();
+	bool flip_x = sprite.isFlippedOnX();
+	bool flip_y = sprite.isFlippedOnY();
+	for (size_t i = 0; i < count; i++)
+	{
+		const auto& instance = instances[i];
+		auto tint = Blend::makeTint(instance.tint[0], instance.tint[1],
+			instance.tint[2], instance.tint[3]);
+		queue(texture, instance.x, instance.y, instance.width * scale,
+			instance.height * scale, angle, instance.src_rect, flip_x, flip_y,
+			tint, instance.z_order);
+	}
+
+	if (mode == ASGE::SpriteSortMode::IMMEDIATE)
+	{
+		flush();
+	}
+}
+
+/**
+*   @brief   Changes how draws are ordered.
+*   @details Anything queued under the old mode is drawn first.
+*   @return  void
+*/
+void SoftwareRenderer::setSpriteMode(ASGE::SpriteSortMode sort_mode)
+{
+	flush();
+	mode = sort_mode;
+	NullRenderer::setSpriteMode(sort_mode);
+}
+
+/**
+*   @brief   Creates a layer.
+*   @details The buffer covers the area's framebuffer pixels, so the
+			 cached pixels need no scaling when rendered.
+*   @return  The layer's handle, or -1 if it has no pixels.
+*/
+int SoftwareRenderer::createLayer(const rect& area)
+{
+	auto layer = std::unique_ptr<Layer>(new Layer);
+	frameBounds(area, layer->left, layer->top, layer->right, layer->bottom);
+	if (layer->left >= layer->right || layer->top >= layer->bottom)
+	{
+		return -1;
+	}
+
+	layer->pixels.assign(static_cast<size_t>(layer->right - layer->left) *
+		(layer->bottom - layer->top), clear_colour);
+
+	int handle = NullRenderer::createLayer(area);
+	if (handle >= static_cast<int>(layer_buffers.size()))
+	{
+		layer_buffers.resize(handle + 1);
+	}
+
+	layer_buffers[handle] = std::move(layer);
+	return handle;
+}
+
+void SoftwareRenderer::destroyLayer(int layer)
+{
+	auto buffer = findLayer(layer);
+	if (!buffer)
+	{
+		return;
+	}
+
+	if (target.pixels == buffer->pixels.data())
+	{
+		endLayer();
+	}
+
+	layer_buffers[layer].reset();
+	NullRenderer::destroyLayer(layer);
+}
+
+/**
+*   @brief   Redirects drawing into part of a layer.
+*   @details Anything queued for the frame is drawn first. The region
+			 is cleared, and draws are clipped to it, so the rest of
+			 the layer keeps its pixels.
+*   @return  void
+*/
+void SoftwareRenderer::beginLayer(int layer, const rect& region)
+{
+	flush();
+	NullRenderer::beginLayer(layer, region);
+
+	auto buffer = findLayer(layer);
+	if (!buffer)
+	{
+		return;
+	}
+
+	int left = 0, top = 0, right = 0, bottom = 0;
+	frameBounds(region, left, top, right, bottom);
+	target.pixels = buffer->pixels.data();
+	target.pitch = buffer->right - buffer->left;
+	target.origin_x = buffer->left;
+	target.origin_y = buffer->top;
+	target.left = std::max(left, buffer->left);
+	target.top = std::max(top, buffer->top);
+	target.right = std::min(right, buffer->right);
+	target.bottom = std::min(bottom, buffer->bottom);
+
+	for (int y = target.top; y < target.bottom; y++)
+	{
+		auto line = target.pixels + static_cast<size_t>(y - target.origin_y) * target.pitch;
+		std::fill(line + target.left - target.origin_x,
+			line + target.right - target.origin_x, clear_colour);
+	}
+}
+
+void SoftwareRenderer::endLayer()
+{
+	flush();
+	targetFramebuffer();
+	NullRenderer::endLayer();
+}
+
+/**
+*   @brief   Copies a layer's pixels into the frame.
+*   @details Anything queued before it is drawn first, so the layer
+			 covers it as it would if drawn in order.
+*   @return  void
+*/
+void SoftwareRenderer::renderLayer(int layer)
+{
+	NullRenderer::renderLayer(layer);
+
+	auto buffer = findLayer(layer);
+	if (!buffer)
+	{
+		return;
+	}
+
+	flush();
+	size_t width = buffer->right - buffer->left;
+	for (int y = buffer->top; y < buffer->bottom; y++)
+	{
+		std::memcpy(framebuffer.data() + static_cast<size_t>(y) * frame_width + buffer->left,
+			buffer->pixels.data() + (y - buffer->top) * width, width * sizeof(uint32_t));
+	}
+}
+
+std::unique_ptr<ASGE::Sprite> SoftwareRenderer::createUniqueSprite()
+{
+	return std::unique_ptr<ASGE::Sprite>(new SoftwareSprite());
+}
+
+ASGE::Sprite* SoftwareRenderer::createRawSprite()
+{
+	return new SoftwareSprite();
+}
+
+const uint32_t* SoftwareRenderer::pixels() const
+{
+	return framebuffer.data();
+}
+
+int SoftwareRenderer::frameWidth() const
+{
+	return frame_width;
+}
+
+int SoftwareRenderer::frameHeight() const
+{
+	return frame_height;
+}
+
+unsigned SoftwareRenderer::threadCount() const
+{
+	return thread_count;
+}
+
+bool SoftwareRenderer::saveFrame(const std::string& file_name) const
+{
+	Png::Image image;
+	image.width = frame_width;
+	image.height = frame_height;
+	image.pixels.resize(framebuffer.size() * sizeof(uint32_t));
+	std::memcpy(image.pixels.data(), framebuffer.data(), image.pixels.size());
+	return Png::save(file_name, image);
+}
+
+/**
+*   @brief   Finds the framebuffer pixels an area covers.
+*   @details Partly covered pixels are included, and the bounds are
+			 clipped to the framebuffer.
+*   @return  void
+*/
+void SoftwareRenderer::frameBounds(const rect& area, int& left, int& top, int& right, int& bottom) const
+{
+	left = std::max(0, floorToInt(area.x * view_scale + view_x));
+	top = std::max(0, floorToInt(area.y * view_scale + view_y));
+	right = std::min(frame_width, -floorToInt(-(area.x + area.length) * view_scale - view_x));
+	bottom = std::min(frame_height, -floorToInt(-(area.y + area.height) * view_scale - view_y));
+}
+
+SoftwareRenderer::Layer* SoftwareRenderer::findLayer(int layer) const
+{
+	if (layer < 0 || layer >= static_cast<int>(layer_buffers.size()))
+	{
+		return nullptr;
+	}
+
+	return layer_buffers[layer].get();
+}
+
+void SoftwareRenderer::targetFramebuffer()
+{
+	target.pixels = framebuffer.data();
+	target.pitch = frame_width;
+	target.origin_x = 0;
+	target.origin_y = 0;
+	target.left = 0;
+	target.top = 0;
+	target.right = frame_width;
+	target.bottom = frame_height;
+}
+
+/**
+*   @brief   Maps a draw onto the framebuffer and queues it.
+*   @details The quad is rotated about its centre. Its bounds are
+			 clipped to the target, and the mapping back to the
+			 texture is stored as steps per pixel.
+*   @return  void
+*/
+void SoftwareRenderer::queue(const SoftwareTexture* texture, float x, float y, float w, float h,
+	float angle, const float src[4], bool flip_x, bool flip_y,
+	const Blend::Tint& tint, float z_order)
+{
+	if (w <= 0 || h <= 0 || tint.a == 0 || framebuffer.empty())
+	{
+		return;
+	}
+
+	Quad quad;
+	quad.texture = texture;
+	quad.z = z_order;
+	quad.tint = tint;
+
+	// the source rectangle, defaulting to the whole texture
+	float src_x = src[0], src_y = src[1], src_w = src[2], src_h = src[3];
+	if (src_w <= 0 || src_h <= 0)
+	{
+		src_x = 0;
+		src_y = 0;
+		src_w = static_cast<float>(texture->getWidth());
+		src_h = static_cast<float>(texture->getHeight());
+	}
+
+	quad.src_left = std::max(0, floorToInt(src_x));
+	quad.src_top = std::max(0, floorToInt(src_y));
+	quad.src_right = std::min(static_cast<int>(texture->getWidth()), floorToInt(src_x + src_w + 0.5f));
+	quad.src_bottom = std::min(static_cast<int>(texture->getHeight()), floorToInt(src_y + src_h + 0.5f));
+	if (quad.src_left >= quad.src_right || quad.src_top >= quad.src_bottom)
+	{
+		return;
+	}
+
+	float cos_a = std::cos(angle);
+	float sin_a = std::sin(angle);
+	float centre_x = x + w / 2;
+	float centre_y = y + h / 2;
+
+	// framebuffer bounds of the rotated corners
+	float min_x = 1e30f, min_y = 1e30f, max_x = -1e30f, max_y = -1e30f;
+	for (int corner = 0; corner < 4; corner++)
+	{
+		float local_x = (corner & 1 ? w : -w) / 2;
+		float local_y = (corner & 2 ? h : -h) / 2;
+		float frame_x = (centre_x + local_x * cos_a - local_y * sin_a) * view_scale + view_x;
+		float frame_y = (centre_y + local_x * sin_a + local_y * cos_a) * view_scale + view_y;
+		min_x = std::min(min_x, frame_x);
+		min_y = std::min(min_y, frame_y);
+		max_x = std::max(max_x, frame_x);
+		max_y = std::max(max_y, frame_y);
+	}
+
+	quad.left = std::max(target.left, floorToInt(min_x));
+	quad.top = std::max(target.top, floorToInt(min_y));
+	quad.right = std::min(target.right, floorToInt(max_x) + 1);
+	quad.bottom = std::min(target.bottom, floorToInt(max_y) + 1);
+	if (quad.left >= quad.right || quad.top >= quad.bottom)
+	{
+		return;
+	}
+
+	// framebuffer pixel centre -> sprite local -> texel
+	float texels_x = (flip_x ? -src_w : src_w) / w / view_scale;
+	float texels_y = (flip_y ? -src_h : src_h) / h / view_scale;
+	quad.dudx = cos_a * texels_x;
+	quad.dudy = sin_a * texels_x;
+	quad.dvdx = -sin_a * texels_y;
+	quad.dvdy = cos_a * texels_y;
+
+	float origin_x = (0.5f - view_x) / view_scale - centre_x;
+	float origin_y = (0.5f - view_y) / view_scale - centre_y;
+	float local_x = cos_a * origin_x + sin_a * origin_y;
+	float local_y = -sin_a * origin_x + cos_a * origin_y;
+	quad.u0 = src_x + src_w / 2 + local_x * (flip_x ? -src_w : src_w) / w;
+	quad.v0 = src_y + src_h / 2 + local_y * (flip_y ? -src_h : src_h) / h;
+
+	quads.push_back(quad);
+}
+
+/**
+*   @brief   Draws everything queued.
+*   @details Queued quads are ordered for the sort mode, then binned
+			 into the tiles they overlap. Small batches are drawn on
+			 the calling thread, as waking the workers costs more
+			 than the work.
+*   @return  void
+*/
+void SoftwareRenderer::flush()
+{
+	if ((quads.empty() && !clear_pending) || framebuffer.empty())
+	{
+		return;
+	}
+
+	switch (mode)
+	{
+	case ASGE::SpriteSortMode::TEXTURE:
+		std::stable_sort(quads.begin(), quads.end(), [](const Quad& a, const Quad& b)
+		{
+			return a.texture < b.texture;
+		});
+		break;
+
+	case ASGE::SpriteSortMode::BACK_TO_FRONT:
+		std::stable_sort(quads.begin(), quads.end(), [](const Quad& a, const Quad& b)
+		{
+			return a.z != b.z ? a.z < b.z : a.texture < b.texture;
+		});
+		break;
+
+	case ASGE::SpriteSortMode::FRONT_TO_BACK:
+		std::stable_sort(quads.begin(), quads.end(), [](const Quad& a, const Quad& b)
+		{
+			return a.z != b.z ? a.z > b.z : a.texture < b.texture;
+		});
+		break;
+
+	default:
+		break;
+	}
+
+	long long area = 0;
+	for (uint32_t i = 0; i < quads.size(); i++)
+	{
+		const auto& quad = quads[i];
+		area += static_cast<long long>(quad.right - quad.left) * (quad.bottom - quad.top);
+		for (int ty = quad.top / TILE_SIZE; ty <= (quad.bottom - 1) / TILE_SIZE; ty++)
+		{
+			for (int tx = quad.left / TILE_SIZE; tx <= (quad.right - 1) / TILE_SIZE; tx++)
+			{
+				tile_quads[ty * tiles_x + tx].push_back(i);
+			}
+		}
+	}
+
+	next_tile = 0;
+	if (workers.empty() || (!clear_pending && area < SERIAL_AREA))
+	{
+		runTiles(row_buffers[0]);
+	}
+	else
+	{
+		{
+			std::lock_guard<std::mutex> lock(work_mutex);
+			generation++;
+			busy_workers = static_cast<unsigned>(workers.size());
+		}
+		work_ready.notify_all();
+
+		runTiles(row_buffers[0]);
+
+		std::unique_lock<std::mutex> lock(work_mutex);
+		work_done.wait(lock, [this] { return busy_workers == 0; });
+	}
+
+	for (auto& bin : tile_quads)
+	{
+		bin.clear();
+	}
+	quads.clear();
+	clear_pending = false;
+}
+
+void SoftwareRenderer::runTiles(std::vector<uint32_t>& row)
+{
+	PROFILE_ZONE("rasterize");
+	for (int tile = next_tile++; tile < tile_count; tile = next_tile++)
+	{
+		rasterizeTile(tile, row);
+	}
+}
+
+void SoftwareRenderer::rasterizeTile(int tile, std::vector<uint32_t>& row)
+{
+	int left = (tile % tiles_x) * TILE_SIZE;
+	int top = (tile / tiles_x) * TILE_SIZE;
+	int right = std::min(left + TILE_SIZE, frame_width);
+	int bottom = std::min(top + TILE_SIZE, frame_height);
+
+	if (clear_pending)
+	{
+		for (int y = top; y < bottom; y++)
+		{
+			auto line = framebuffer.data() + static_cast<size_t>(y) * frame_width;
+			std::fill(line + left, line + right, clear_colour);
+		}
+	}
+
+	for (auto index : tile_quads[tile])
+	{
+		const auto& quad = quads[index];
+		rasterize(quad, std::max(left, quad.left), std::max(top, quad.top),
+			std::min(right, quad.right), std::min(bottom, quad.bottom), row);
+	}
+}
+
+/**
+*   @brief   Draws part of a quad.
+*   @details Each row is sampled into a buffer, with texels outside
+			 the source rectangle left transparent, then the covered
+			 part of the row is blended in one span.
+*   @return  void
+*/
+void SoftwareRenderer::rasterize(const Quad& quad, int left, int top, int right, int bottom,
+	std::vector<uint32_t>& row)
+{
+	const auto texels = quad.texture->texels();
+	const int pitch = static_cast<int>(quad.texture->getWidth());
+
+	for (int y = top; y < bottom; y++)
+	{
+		float u = quad.u0 + left * quad.dudx + y * quad.dudy;
+		float v = quad.v0 + left * quad.dvdx + y * quad.dvdy;
+
+		int first = -1, last = -1;
+		for (int x = left; x < right; x++, u += quad.dudx, v += quad.dvdx)
+		{
+			int tu = floorToInt(u);
+			int tv = floorToInt(v);
+			auto& texel = row[x - left];
+			if (tu < quad.src_left || tu >= quad.src_right ||
+				tv < quad.src_top || tv >= quad.src_bottom)
+			{
+				texel = 0;
+				continue;
+			}
+
+			texel = texels[tv * pitch + tu];
+			if (first < 0)
+			{
+				first = x - left;
+			}
+			last = x - left;
+		}
+
+		if (first >= 0)
+		{
+			auto line = target.pixels + static_cast<size_t>(y - target.origin_y) * target.pitch +
+				left - target.origin_x;
+			Blend::span(line + first, row.data() + first, last - first + 1, quad.tint);
+		}
+	}
+}
+
+void SoftwareRenderer::workerLoop(unsigned index)
+{
+	PROFILE_THREAD("raster " + std::to_string(index));
+	unsigned seen = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(work_mutex);
+			work_ready.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping)
+			{
+				return;
+			}
+			seen = generation;
+		}
+
+		runTiles(row_buffers[index]);
+
+		std::lock_guard<std::mutex> lock(work_mutex);
+		if (--busy_workers == 0)
+		{
+			work_done.notify_one();
+		}
+	}
+}
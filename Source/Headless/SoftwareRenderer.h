@@ -0,0 +1,220 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Blend.h"
+#include "NullRenderer.h"
+
+/**
+*  A texture held in system memory as 8 bit RGBA.
+*  The pixels are either owned, or borrowed from memory that outlives
+*  the texture, such as a mapped asset archive.
+*/
+class SoftwareTexture : public ASGE::Texture2D
+{
+public:
+	SoftwareTexture(int width, int height, std::vector<uint32_t> pixels);
+	SoftwareTexture(int width, int height, const uint32_t* borrowed_pixels);
+
+	void  setData(void* data) override;
+	void* getData() override;
+
+	/**
+	*  Returns the pixels, row by row.
+	*  @return width * height RGBA pixels.
+	*/
+	const uint32_t* texels() const;
+
+private:
+	std::vector<uint32_t> owned;
+	const uint32_t* pixels = nullptr;
+};
+
+/**
+*  A sprite for the software renderer.
+*  Textures are decoded into system memory when loaded.
+*/
+class SoftwareSprite : public ASGE::Sprite, public MemoryTextureSprite
+{
+public:
+	SoftwareSprite();
+
+	bool loadTexture(const std::string& file_name) override;
+	bool loadTextureFromMemory(const void* pixels, int width, int height) override;
+	const ASGE::Texture2D* getTexture() const override;
+
+private:
+	void setTexture(std::unique_ptr<SoftwareTexture> new_texture);
+	std::unique_ptr<SoftwareTexture> texture;
+};
+
+/**
+*  A renderer that rasterizes on the CPU into an RGBA framebuffer.
+*  Sprites are drawn with their position, scale, rotation, tint,
+*  opacity, flip flags and source rectangle, and text with a built
+*  in bitmap font. Drawing is queued and ordered as the current
+*  SpriteSortMode describes: immediate draws straight away, deferred
+*  keeps the submitted order, and the sorting modes order by texture
+*  and z before drawing. Queued draws are binned into screen tiles
+*  which are rasterized in parallel. Layers are kept as buffers the
+*  size of their area, which draws are redirected into.
+*
+*  The game is drawn at its design resolution unless an output size
+*  is given, in which case it is scaled uniformly to fit and centred.
+*  The null renderer's counters are kept as well.
+*/
+class SoftwareRenderer : public NullRenderer
+{
+public:
+
+	/**
+	*  Constructor.
+	*  @param [in] thread_count The threads that rasterize, including
+	*  the caller. 0 uses one per hardware thread.
+	*/
+	explicit SoftwareRenderer(unsigned thread_count = 0);
+	~SoftwareRenderer() override;
+
+	/**
+	*  Sets the size of the framebuffer. Must be called before init.
+	*  @param [in] width The width in pixels, or 0 for the design width.
+	*  @param [in] height The height in pixels, or 0 for the design height.
+	*/
+	void setOutputSize(int width, int height);
+
+	bool init(int w, int h, WindowMode mode) override;
+	bool exit() override;
+	void preRender() override;
+	void postRender() override;
+	void renderText(const char* text, size_t length, int x, int y, float scale,
+		const ASGE::Colour& colour, float z_order) override;
+	void renderSprite(const ASGE::Sprite& sprite, float z_order) override;
+	void renderSprites(const ASGE::Sprite& sprite,
+		const SpriteInstance* instances, size_t count) override;
+	void setSpriteMode(ASGE::SpriteSortMode mode) override;
+	int  createLayer(const rect& area) override;
+	void destroyLayer(int layer) override;
+	void beginLayer(int layer, const rect& region) override;
+	void endLayer() override;
+	void renderLayer(int layer) override;
+	std::unique_ptr<ASGE::Sprite> createUniqueSprite() override;
+	ASGE::Sprite* createRawSprite() override;
+
+	using NullRenderer::renderSprite;
+	using NullRenderer::renderText;
+
+	/**
+	*  Returns the framebuffer, as tightly packed RGBA rows.
+	*  @return frameWidth() * frameHeight() pixels.
+	*/
+	const uint32_t* pixels() const;
+	int frameWidth() const;
+	int frameHeight() const;
+
+	/**
+	*  Returns the number of threads that rasterize.
+	*  @return the thread count, including the caller.
+	*/
+	unsigned threadCount() const;
+
+	/**
+	*  Writes the framebuffer to a PNG file.
+	*  @param [in] file_name The file to write.
+	*  @return true if the file was written.
+	*/
+	bool saveFrame(const std::string& file_name) const;
+
+private:
+
+	/**
+	*  A draw, mapped to the framebuffer.
+	*  Each framebuffer pixel centre maps linearly to a texel, which
+	*  is drawn if it lies within the source rectangle.
+	*/
+	struct Quad
+	{
+		const SoftwareTexture* texture = nullptr;
+		float z = 0;
+		Blend::Tint tint;
+		float u0 = 0, dudx = 0, dudy = 0;
+		float v0 = 0, dvdx = 0, dvdy = 0;
+		int src_left = 0, src_top = 0, src_right = 0, src_bottom = 0;
+		int left = 0, top = 0, right = 0, bottom = 0;
+	};
+
+	/**
+	*  Pixels that draws are written to, either the framebuffer or a
+	*  layer. Positions are in framebuffer pixels, and the origin is
+	*  the position of the first pixel.
+	*/
+	struct Target
+	{
+		uint32_t* pixels = nullptr;
+		int pitch = 0;
+		int origin_x = 0, origin_y = 0;
+		int left = 0, top = 0, right = 0, bottom = 0;
+	};
+
+	/**
+	*  A layer's cached pixels and the framebuffer area they cover.
+	*/
+	struct Layer
+	{
+		std::vector<uint32_t> pixels;
+		int left = 0, top = 0, right = 0, bottom = 0;
+	};
+
+	void frameBounds(const rect& area, int& left, int& top, int& right, int& bottom) const;
+	Layer* findLayer(int layer) const;
+	void targetFramebuffer();
+	void queue(const SoftwareTexture* texture, float x, float y, float w, float h,
+		float angle, const float src[4], bool flip_x, bool flip_y,
+		const Blend::Tint& tint, float z_order);
+	void flush();
+	void runTiles(std::vector<uint32_t>& row);
+	void rasterizeTile(int tile, std::vector<uint32_t>& row);
+	void rasterize(const Quad& quad, int left, int top, int right, int bottom,
+		std::vector<uint32_t>& row);
+	void workerLoop(unsigned index);
+
+	static const int TILE_SIZE = 64;
+
+	ASGE::SpriteSortMode mode = ASGE::SpriteSortMode::IMMEDIATE;
+	std::vector<Quad> quads;
+	std::unique_ptr<SoftwareTexture> font_texture;
+
+	std::vector<uint32_t> framebuffer;
+	std::vector<std::unique_ptr<Layer>> layer_buffers;
+	Target target;
+	int output_width = 0;
+	int output_height = 0;
+	int frame_width = 0;
+	int frame_height = 0;
+	float view_scale = 1;
+	float view_x = 0;
+	float view_y = 0;
+	bool clear_pending = false;
+	uint32_t clear_colour = 0;
+
+	int tiles_x = 0;
+	int tiles_y = 0;
+	int tile_count = 0;
+	std::vector<std::vector<uint32_t>> tile_quads;
+	std::vector<std::vector<uint32_t>> row_buffers;
+
+	unsigned thread_count = 1;
+	std::vector<std::thread> workers;
+	std::mutex work_mutex;
+	std::condition_variable work_ready;
+	std::condition_variable work_done;
+	std::atomic<int> next_tile{ 0 };
+	unsigned generation = 0;
+	unsigned busy_workers = 0;
+	bool stopping = false;
+};
@@ -0,0 +1,51 @@
+#include <cstdio>
+
+#include "Hud.h"
+
+int Hud::addCounter(const char* label, int x, int y)
+{
+	counters.emplace_back();
+	auto& counter = counters.back();
+	counter.label = label;
+	counter.x = x;
+	counter.y = y;
+	layout(counter);
+	return static_cast<int>(counters.size()) - 1;
+}
+
+void Hud::set(int counter, int value)
+{
+	auto& entry = counters[counter];
+	if (entry.value != value)
+	{
+		entry.value = value;
+		layout(entry);
+	}
+}
+
+/**
+*   @brief   Records the counters.
+*   @details The text is copied from each counter's buffer without
+			 building a string.
+*   @return  void
+*/
+void Hud::record(RenderCommandList& commands, const ASGE::Colour& colour) const
+{
+	for (const auto& counter : counters)
+	{
+		commands.addText(counter.text, counter.length,
+			counter.x, counter.y, 1.0f, colour);
+	}
+}
+
+/**
+*   @brief   Formats a counter's text.
+*   @details Text that does not fit the buffer is cut short.
+*   @return  void
+*/
+void Hud::layout(Counter& counter)
+{
+	int written = std::snprintf(counter.text, TEXT_SIZE, "%s%d", counter.label, counter.value);
+	counter.length = written < 0 ? 0 :
+		written < static_cast<int>(TEXT_SIZE) ? static_cast<size_t>(written) : TEXT_SIZE - 1;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include <Engine/Colours.h>
+
+#include "RenderCommands.h"
+
+/**
+*  Labelled counters drawn over the game, such as the score.
+*  Each counter's text is kept in a fixed buffer and only formatted
+*  again when its value changes, so recording the HUD allocates nothing
+*  once the counters have been added.
+*/
+class Hud
+{
+public:
+
+	/**
+	*  Adds a counter, drawn as its label followed by its value.
+	*  @param [in] label The text before the value. Must outlive the HUD.
+	*  @param [in] x The text position in the X axis.
+	*  @param [in] y The text starting position in the Y axis.
+	*  @return the counter's handle.
+	*/
+	int addCounter(const char* label, int x, int y);
+
+	/**
+	*  Updates a counter's value. Its text is laid out again only if
+	*  the value differs from the last one.
+	*  @param [in] counter The counter's handle.
+	*  @param [in] value The value to show.
+	*/
+	void set(int counter, int value);
+
+	/**
+	*  Adds every counter's text to a frame.
+	*  @param [in] commands The frame being recorded.
+	*  @param [in] colour The colour of the text.
+	*/
+	void record(RenderCommandList& commands, const ASGE::Colour& colour) const;
+
+private:
+	static const size_t TEXT_SIZE = 48;
+
+	struct Counter
+	{
+		const char* label = nullptr;
+		int x = 0;
+		int y = 0;
+		int value = 0;
+		char text[TEXT_SIZE]{};
+		size_t length = 0;
+	};
+
+	void layout(Counter& counter);
+
+	std::vector<Counter> counters;
+};
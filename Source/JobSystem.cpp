@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <string>
+
+#include "JobSystem.h"
+#include "Profiler.h"
+
+namespace
+{
+	/**
+	*  The job system a worker thread belongs to, and its queue.
+	*  Any other thread uses queue 0.
+	*/
+	struct WorkerIdentity
+	{
+		const void* system = nullptr;
+		unsigned queue = 0;
+	};
+
+	thread_local WorkerIdentity worker_identity;
+}
+
+JobGraph::Job JobGraph::add(std::function<void()> work)
+{
+	std::unique_ptr<Node> node(new Node);
+	node->work = std::move(work);
+	nodes.push_back(std::move(node));
+	return static_cast<Job>(nodes.size()) - 1;
+}
+
+JobGraph::Job JobGraph::parallelFor(std::function<size_t()> count, size_t grain, RangeFunction body)
+{
+	std::unique_ptr<Node> node(new Node);
+	node->count = std::move(count);
+	node->grain = std::max<size_t>(grain, 1);
+	node->body = std::move(body);
+	nodes.push_back(std::move(node));
+	return static_cast<Job>(nodes.size()) - 1;
+}
+
+void JobGraph::precede(Job first, Job then)
+{
+	nodes[first]->successors.push_back(nodes[then].get());
+	nodes[then]->predecessors++;
+}
+
+size_t JobGraph::size() const
+{
+	return nodes.size();
+}
+
+/**
+*   @brief   Constructor.
+*   @details Queue 0 is shared by threads outside the system, the
+			 workers have one each.
+*/
+JobSystem::JobSystem(unsigned threads)
+{
+	thread_count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned i = 0; i < thread_count; i++)
+	{
+		queues.emplace_back(new Queue);
+	}
+	for (unsigned i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+/**
+*   @brief   Runs a graph to completion.
+*   @details Jobs without dependencies are started; the caller runs
+			 the first of them itself and queues the rest. It then
+			 runs or steals jobs until every job has finished.
+*   @return  void
+*/
+void JobSystem::run(JobGraph& graph)
+{
+	if (graph.nodes.empty())
+	{
+		return;
+	}
+
+	graph.unfinished.store(graph.nodes.size());
+	for (auto& node : graph.nodes)
+	{
+		node->waiting.store(node->predecessors);
+	}
+
+	Task first;
+	for (auto& node : graph.nodes)
+	{
+		if (node->predecessors != 0)
+		{
+			continue;
+		}
+
+		auto task = start(graph, node.get());
+		if (!first.node)
+		{
+			first = task;
+		}
+		else if (task.node)
+		{
+			push(task);
+		}
+	}
+	execute(first);
+
+	help([&graph] { return graph.unfinished.load(std::memory_order_acquire) == 0; });
+}
+
+/**
+*   @brief   Runs jobs until told to stop.
+*   @details With nothing to run, the thread yields rather than
+			 sleeping, as the condition may change at any moment.
+*   @return  void
+*/
+void JobSystem::help(const std::function<bool()>& done)
+{
+	while (!done())
+	{
+		Task task;
+		if (next(task))
+		{
+			execute(task);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+unsigned JobSystem::threadCount() const
+{
+	return thread_count;
+}
+
+unsigned JobSystem::queueIndex() const
+{
+	return worker_identity.system == this ? worker_identity.queue : 0;
+}
+
+/**
+*   @brief   Queues a task on the calling thread's queue.
+*   @details A sleeping worker is woken to steal it. The count of
+			 queued tasks is raised before checking for sleepers,
+			 and sleepers check it after saying they sleep, so
+			 either the sleeper sees the task or it is woken.
+*   @return  void
+*/
+void JobSystem::push(const Task& task)
+{
+	auto& queue = *queues[queueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(task);
+	}
+	queued++;
+
+	if (sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		wake.notify_one();
+	}
+}
+
+bool JobSystem::pop(Task& task)
+{
+	auto& queue = *queues[queueIndex()];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.tasks.size() == queue.front)
+	{
+		return false;
+	}
+
+	task = queue.tasks.back();
+	queue.tasks.pop_back();
+	if (queue.tasks.size() == queue.front)
+	{
+		queue.tasks.clear();
+		queue.front = 0;
+	}
+	queued--;
+	return true;
+}
+
+/**
+*   @brief   Takes the oldest task from another thread's queue.
+*   @details Queues are tried in turn, starting after the thief's
+			 own, so thieves spread out over their victims.
+*   @return  True if a task was stolen.
+*/
+bool JobSystem::steal(Task& task)
+{
+	auto self = queueIndex();
+	for (unsigned i = 1; i < thread_count; i++)
+	{
+		auto& queue = *queues[(self + i) % thread_count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.size() == queue.front)
+		{
+			continue;
+		}
+
+		task = queue.tasks[queue.front++];
+		if (queue.tasks.size() == queue.front)
+		{
+			queue.tasks.clear();
+			queue.front = 0;
+		}
+		queued--;
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::next(Task& task)
+{
+	return queued.load() > 0 && (pop(task) || steal(task));
+}
+
+/**
+*   @brief   Runs a task, then whatever it makes ready.
+*   @details Once a job's last chunk finishes, the first job that
+			 becomes ready runs next on this thread, and any others
+			 are queued.
+*   @return  void
+*/
+void JobSystem::execute(Task task)
+{
+	while (task.node)
+	{
+		auto node = task.node;
+		if (node->body)
+		{
+			node->body(task.begin, task.end);
+			if (node->chunks.fetch_sub(1) != 1)
+			{
+				return;
+			}
+		}
+		else if (node->work)
+		{
+			node->work();
+		}
+
+		task = finish(*task.graph, node);
+	}
+}
+
+/**
+*   @brief   Starts a job whose dependencies have finished.
+*   @details A parallel for is split into chunks, all but the first
+			 of which are queued. An empty range finishes at once.
+*   @return  The task to run for the job, if any.
+*/
+JobSystem::Task JobSystem::start(JobGraph& graph, JobGraph::Node* node)
+{
+	Task task;
+	task.graph = &graph;
+	task.node = node;
+
+	if (!node->body)
+	{
+		return task;
+	}
+
+	auto count = node->count();
+	if (count == 0)
+	{
+		return finish(graph, node);
+	}
+
+	auto chunks = (count + node->grain - 1) / node->grain;
+	node->chunks.store(chunks);
+	for (size_t chunk = 1; chunk < chunks; chunk++)
+	{
+		Task part = task;
+		part.begin = chunk * node->grain;
+		part.end = std::min(count, part.begin + node->grain);
+		push(part);
+	}
+
+	task.end = std::min(count, node->grain);
+	return task;
+}
+
+/**
+*   @brief   Marks a job as finished.
+*   @details Starts every job that was only waiting for this one.
+*   @return  The task to run next on this thread, if any.
+*/
+JobSystem::Task JobSystem::finish(JobGraph& graph, JobGraph::Node* node)
+{
+	Task next_task;
+	for (auto successor : node->successors)
+	{
+		if (successor->waiting.fetch_sub(1) != 1)
+		{
+			continue;
+		}
+
+		auto task = start(graph, successor);
+		if (!next_task.node)
+		{
+			next_task = task;
+		}
+		else if (task.node)
+		{
+			push(task);
+		}
+	}
+
+	graph.unfinished.fetch_sub(1, std::memory_order_release);
+	return next_task;
+}
+
+void JobSystem::workerLoop(unsigned index)
+{
+	worker_identity.system = this;
+	worker_identity.queue = index;
+	PROFILE_THREAD("jobs " + std::to_string(index));
+
+	while (true)
+	{
+		Task task;
+		if (next(task))
+		{
+			execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleeping++;
+		wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+		sleeping--;
+		if (stopping)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+*  A set of jobs and the order they must run in.
+*  A graph is built once and run as often as needed. Jobs only start
+*  once every job they depend on has finished, and anything those
+*  jobs wrote is visible to them. A parallel for is a single job
+*  whose range is split into chunks, which run on any thread.
+*/
+class JobGraph
+{
+public:
+	using Job = int;
+	using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+	/**
+	*  Adds a job.
+	*  @param [in] work The work to run.
+	*  @return the job's handle.
+	*/
+	Job add(std::function<void()> work);
+
+	/**
+	*  Adds a job that runs a function over a range of indices.
+	*  The range is split into chunks of at most grain indices, so a
+	*  range no larger than the grain runs on one thread.
+	*  @param [in] count Returns the size of the range, when the job starts.
+	*  @param [in] grain The most indices to give to one chunk.
+	*  @param [in] body The work to run for each chunk.
+	*  @return the job's handle.
+	*/
+	Job parallelFor(std::function<size_t()> count, size_t grain, RangeFunction body);
+
+	/**
+	*  Makes one job wait for another to finish before it starts.
+	*  @param [in] first The job to finish first.
+	*  @param [in] then The job that waits for it.
+	*/
+	void precede(Job first, Job then);
+
+	/**
+	*  Returns the number of jobs.
+	*  @return the job count.
+	*/
+	size_t size() const;
+
+private:
+	friend class JobSystem;
+
+	struct Node
+	{
+		std::function<void()> work;
+		std::function<size_t()> count;
+		RangeFunction body;
+		size_t grain = 1;
+		std::vector<Node*> successors;
+		int predecessors = 0;
+		std::atomic<int> waiting{ 0 };     /**< Predecessors yet to finish this run. */
+		std::atomic<size_t> chunks{ 0 };   /**< Chunks yet to finish this run. */
+	};
+
+	std::vector<std::unique_ptr<Node>> nodes;
+	std::atomic<size_t> unfinished{ 0 };
+};
+
+/**
+*  Runs job graphs on a pool of threads.
+*  Every thread has its own queue of work. Threads take their newest
+*  work first, which is the most likely to still be in cache, and
+*  when out of work steal the oldest from another thread. When a job
+*  finishes, the thread that ran it carries straight on with a job
+*  it made ready, so a chain of jobs runs on one thread without
+*  passing through a queue. Threads with nothing to steal sleep.
+*/
+class JobSystem
+{
+public:
+
+	/**
+	*  Constructor. Starts the worker threads, which wait for work.
+	*  @param [in] thread_count The threads that run jobs, including
+	*  the caller. 0 uses one per hardware thread.
+	*/
+	explicit JobSystem(unsigned thread_count = 0);
+
+	/**
+	*  Destructor. Stops the worker threads.
+	*  No graph may be running.
+	*/
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/**
+	*  Runs every job in a graph, and returns once they have all
+	*  finished. The calling thread runs jobs too, rather than waiting.
+	*  A graph must not be run again until the last run has returned.
+	*  @param [in] graph The jobs to run.
+	*/
+	void run(JobGraph& graph);
+
+	/**
+	*  Runs queued jobs on the calling thread until a condition is met.
+	*  Lets a thread that would otherwise wait on another help it.
+	*  @param [in] done Returns true once the caller may stop helping.
+	*/
+	void help(const std::function<bool()>& done);
+
+	/**
+	*  Returns the number of threads that run jobs.
+	*  @return the thread count, including the caller.
+	*/
+	unsigned threadCount() const;
+
+private:
+
+	/**
+	*  A job to run, or a chunk of a parallel for.
+	*/
+	struct Task
+	{
+		JobGraph* graph = nullptr;
+		JobGraph::Node* node = nullptr;
+		size_t begin = 0;
+		size_t end = 0;
+	};
+
+	/**
+	*  A thread's tasks. The owner pushes and pops at the back,
+	*  thieves take from the front. Emptying it keeps its capacity.
+	*/
+	struct Queue
+	{
+		std::mutex mutex;
+		std::vector<Task> tasks;
+		size_t front = 0;
+	};
+
+	unsigned queueIndex() const;
+	void push(const Task& task);
+	bool pop(Task& task);
+	bool steal(Task& task);
+	bool next(Task& task);
+	void execute(Task task);
+	Task start(JobGraph& graph, JobGraph::Node* node);
+	Task finish(JobGraph& graph, JobGraph::Node* node);
+	void workerLoop(unsigned index);
+
+	unsigned thread_count = 1;
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<int> queued{ 0 };
+	std::atomic<int> sleeping{ 0 };
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "Rect.h"
+
+/**
+*  Implemented by renderers that can keep drawn content between frames.
+*  A layer caches part of the screen. It is only redrawn where it is
+*  told it has changed, and the cached pixels are copied into each
+*  frame. Content that rarely changes, such as the brick field, then
+*  costs the same to draw however much of it there is.
+*
+*  Layers are opaque: redrawn regions are filled with the clear colour
+*  before sprites are drawn over it, and rendering a layer replaces
+*  what is beneath it. Draw layers before anything that covers them.
+*/
+class LayerRenderer
+{
+public:
+	virtual ~LayerRenderer() = default;
+
+	/**
+	*  Creates a layer. Its contents start undefined, so the whole
+	*  area must be drawn before it is first rendered.
+	*  @param [in] area The part of the screen the layer covers.
+	*  @return the layer's handle, or -1 if it could not be created.
+	*/
+	virtual int createLayer(const rect& area) = 0;
+
+	/**
+	*  Frees a layer.
+	*  @param [in] layer The layer's handle.
+	*/
+	virtual void destroyLayer(int layer) = 0;
+
+	/**
+	*  Starts redrawing part of a layer.
+	*  The region is cleared, then sprites and text submitted until
+	*  endLayer are drawn into the layer, clipped to the region.
+	*  @param [in] layer The layer's handle.
+	*  @param [in] region The part of the screen that changed.
+	*/
+	virtual void beginLayer(int layer, const rect& region) = 0;
+
+	/**
+	*  Finishes redrawing a layer. Later submissions draw to the frame.
+	*/
+	virtual void endLayer() = 0;
+
+	/**
+	*  Draws a layer's cached contents into the frame.
+	*  @param [in] layer The layer's handle.
+	*/
+	virtual void renderLayer(int layer) = 0;
+};
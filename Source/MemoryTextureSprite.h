@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+*  Implemented by sprites that can take their texture from memory.
+*  ASGE sprites only load textures from files. Renderers written for
+*  this game can also implement this interface on their sprites, and
+*  the texture cache will then load textures straight from the asset
+*  archive rather than reading and decoding the image files.
+*/
+class MemoryTextureSprite
+{
+public:
+	virtual ~MemoryTextureSprite() = default;
+
+	/**
+	*  Uses pixels already in memory as the sprite's texture.
+	*  The pixels are not copied and must remain valid for as long
+	*  as the texture is in use.
+	*  @param [in] pixels Tightly packed 8 bit RGBA pixels.
+	*  @param [in] width The width of the image.
+	*  @param [in] height The height of the image.
+	*  @return true if the texture was created.
+	*/
+	virtual bool loadTextureFromMemory(const void* pixels, int width, int height) = 0;
+};
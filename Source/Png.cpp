@@ -0,0 +1,618 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "Png.h"
+
+namespace
+{
+	const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	uint32_t readBigEndian(const uint8_t* data)
+	{
+		return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) |
+			(uint32_t(data[2]) << 8) | uint32_t(data[3]);
+	}
+
+	void writeBigEndian(std::vector<uint8_t>& out, uint32_t value)
+	{
+		out.push_back(static_cast<uint8_t>(value >> 24));
+		out.push_back(static_cast<uint8_t>(value >> 16));
+		out.push_back(static_cast<uint8_t>(value >> 8));
+		out.push_back(static_cast<uint8_t>(value));
+	}
+
+	uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+	{
+		static uint32_t table[256] = { 0 };
+		if (!table[1])
+		{
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				uint32_t c = n;
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				}
+				table[n] = c;
+			}
+		}
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	uint32_t adler32(const uint8_t* data, size_t size)
+	{
+		uint32_t a = 1, b = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			a = (a + data[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	/**
+	*  A canonical Huffman decoding table as used by DEFLATE.
+	*/
+	struct Huffman
+	{
+		uint16_t counts[16];
+		uint16_t symbols[288];
+
+		void build(const uint8_t* lengths, int count)
+		{
+			uint16_t offsets[16];
+			std::memset(counts, 0, sizeof(counts));
+			for (int i = 0; i < count; i++)
+			{
+				counts[lengths[i]]++;
+			}
+			counts[0] = 0;
+
+			offsets[1] = 0;
+			for (int i = 1; i < 15; i++)
+			{
+				offsets[i + 1] = offsets[i] + counts[i];
+			}
+			for (int i = 0; i < count; i++)
+			{
+				if (lengths[i])
+				{
+					symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+				}
+			}
+		}
+	};
+
+	/**
+	*  Decompresses a zlib stream, following RFC 1950 and 1951.
+	*/
+	class Inflater
+	{
+	public:
+		Inflater(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+		bool run(std::vector<uint8_t>& out)
+		{
+			if (size < 2 || (data[0] & 0x0f) != 8 || ((data[0] << 8) | data[1]) % 31)
+			{
+				return false;
+			}
+			pos = 2;
+
+			bool last = false;
+			while (!last)
+			{
+				last = bits(1) != 0;
+				auto type = bits(2);
+
+				bool ok = false;
+				if (type == 0)
+				{
+					ok = stored(out);
+				}
+				else if (type == 1)
+				{
+					fixedTables();
+					ok = block(out);
+				}
+				else if (type == 2)
+				{
+					ok = dynamicTables() && block(out);
+				}
+
+				if (!ok || overrun)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		int bits(int count)
+		{
+			while (bit_count < count)
+			{
+				if (pos >= size)
+				{
+					overrun = true;
+					return 0;
+				}
+				bit_buffer |= uint32_t(data[pos++]) << bit_count;
+				bit_count += 8;
+			}
+
+			int value = static_cast<int>(bit_buffer & ((1u << count) - 1));
+			bit_buffer >>= count;
+			bit_count -= count;
+			return value;
+		}
+
+		int decodeSymbol(const Huffman& table)
+		{
+			int code = 0, first = 0, index = 0;
+			for (int len = 1; len < 16; len++)
+			{
+				code |= bits(1);
+				int count = table.counts[len];
+				if (code - count < first)
+				{
+					return table.symbols[index + (code - first)];
+				}
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+
+			overrun = true;
+			return 0;
+		}
+
+		bool stored(std::vector<uint8_t>& out)
+		{
+			bit_buffer = 0;
+			bit_count = 0;
+			if (pos + 4 > size)
+			{
+				return false;
+			}
+
+			auto len = data[pos] | (data[pos + 1] << 8);
+			auto nlen = data[pos + 2] | (data[pos + 3] << 8);
+			pos += 4;
+			if ((len ^ 0xffff) != nlen || pos + len > size)
+			{
+				return false;
+			}
+
+			out.insert(out.end(), data + pos, data + pos + len);
+			pos += len;
+			return true;
+		}
+
+		void fixedTables()
+		{
+			uint8_t lengths[288];
+			int i = 0;
+			for (; i < 144; i++) lengths[i] = 8;
+			for (; i < 256; i++) lengths[i] = 9;
+			for (; i < 280; i++) lengths[i] = 7;
+			for (; i < 288; i++) lengths[i] = 8;
+			literals.build(lengths, 288);
+
+			for (i = 0; i < 30; i++) lengths[i] = 5;
+			distances.build(lengths, 30);
+		}
+
+		bool dynamicTables()
+		{
+			static const uint8_t order[19] =
+				{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+			auto literal_count = bits(5) + 257;
+			auto distance_count = bits(5) + 1;
+			auto code_count = bits(4) + 4;
+
+			uint8_t lengths[288 + 32] = { 0 };
+			for (int i = 0; i < code_count; i++)
+			{
+				lengths[order[i]] = static_cast<uint8_t>(bits(3));
+			}
+
+			Huffman codes;
+			codes.build(lengths, 19);
+
+			std::memset(lengths, 0, sizeof(lengths));
+			int n = 0;
+			while (n < literal_count + distance_count && !overrun)
+			{
+				auto symbol = decodeSymbol(codes);
+				if (symbol < 16)
+				{
+					lengths[n++] = static_cast<uint8_t>(symbol);
+					continue;
+				}
+
+				int repeat = 0;
+				uint8_t value = 0;
+				if (symbol == 16)
+				{
+					if (n == 0)
+					{
+						return false;
+					}
+					value = lengths[n - 1];
+					repeat = 3 + bits(2);
+				}
+				else if (symbol == 17)
+				{
+					repeat = 3 + bits(3);
+				}
+				else
+				{
+					repeat = 11 + bits(7);
+				}
+
+				if (n + repeat > literal_count + distance_count)
+				{
+					return false;
+				}
+				while (repeat--)
+				{
+					lengths[n++] = value;
+				}
+			}
+
+			literals.build(lengths, literal_count);
+			distances.build(lengths + literal_count, distance_count);
+			return !overrun;
+		}
+
+		bool block(std::vector<uint8_t>& out)
+		{
+			static const uint16_t length_base[29] = {
+				3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+				35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+			static const uint8_t length_extra[29] = {
+				0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+				3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+			static const uint16_t distance_base[30] = {
+				1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+				257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+				8193, 12289, 16385, 24577 };
+			static const uint8_t distance_extra[30] = {
+				0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+				7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+			while (!overrun)
+			{
+				auto symbol = decodeSymbol(literals);
+				if (symbol < 256)
+				{
+					out.push_back(static_cast<uint8_t>(symbol));
+					continue;
+				}
+				if (symbol == 256)
+				{
+					return true;
+				}
+
+				symbol -= 257;
+				if (symbol >= 29)
+				{
+					return false;
+				}
+				auto length = length_base[symbol] + bits(length_extra[symbol]);
+
+				auto distance_symbol = decodeSymbol(distances);
+				if (distance_symbol >= 30)
+				{
+					return false;
+				}
+				size_t distance = distance_base[distance_symbol] +
+					bits(distance_extra[distance_symbol]);
+				if (distance > out.size())
+				{
+					return false;
+				}
+
+				auto from = out.size() - distance;
+				for (int i = 0; i < length; i++)
+				{
+					out.push_back(out[from + i]);
+				}
+			}
+
+			return false;
+		}
+
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		size_t pos = 0;
+		uint32_t bit_buffer = 0;
+		int bit_count = 0;
+		bool overrun = false;
+		Huffman literals;
+		Huffman distances;
+	};
+
+	uint8_t paeth(int a, int b, int c)
+	{
+		int p = a + b - c;
+		int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+		if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+		if (pb <= pc) return static_cast<uint8_t>(b);
+		return static_cast<uint8_t>(c);
+	}
+
+	void writeChunk(std::vector<uint8_t>& out, const char* type,
+		const uint8_t* data, size_t size)
+	{
+		writeBigEndian(out, static_cast<uint32_t>(size));
+		auto start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data, data + size);
+		writeBigEndian(out, crc32(&out[start], out.size() - start));
+	}
+
+	bool readFile(const std::string& file_name, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(file_name, std::ios::binary);
+		if (!file)
+		{
+			return false;
+		}
+
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+}
+
+/**
+*   @brief   Decodes a PNG file held in memory.
+*   @details Collects the IDAT chunks, inflates them, reverses the
+			 per row filters and expands the result to RGBA.
+*   @return  True if the image was decoded.
+*/
+bool Png::decode(const uint8_t* data, size_t size, Image& image)
+{
+	if (size < 33 || std::memcmp(data, SIGNATURE, 8) != 0)
+	{
+		return false;
+	}
+
+	int width = 0, height = 0, colour_type = 0;
+	std::vector<uint8_t> compressed;
+	std::vector<uint8_t> palette;
+	std::vector<uint8_t> transparency;
+
+	size_t pos = 8;
+	while (pos + 12 <= size)
+	{
+		auto length = readBigEndian(data + pos);
+		auto type = data + pos + 4;
+		auto chunk = data + pos + 8;
+		if (length > size - pos - 12)
+		{
+			return false;
+		}
+
+		if (std::memcmp(type, "IHDR", 4) == 0)
+		{
+			width = static_cast<int>(readBigEndian(chunk));
+			height = static_cast<int>(readBigEndian(chunk + 4));
+			colour_type = chunk[9];
+
+			// only 8 bit, non-interlaced images are supported
+			if (chunk[8] != 8 || chunk[12] != 0 || width <= 0 || height <= 0)
+			{
+				return false;
+			}
+		}
+		else if (std::memcmp(type, "PLTE", 4) == 0)
+		{
+			palette.assign(chunk, chunk + length);
+		}
+		else if (std::memcmp(type, "tRNS", 4) == 0)
+		{
+			transparency.assign(chunk, chunk + length);
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0)
+		{
+			compressed.insert(compressed.end(), chunk, chunk + length);
+		}
+		else if (std::memcmp(type, "IEND", 4) == 0)
+		{
+			break;
+		}
+
+		pos += length + 12;
+	}
+
+	int channels = 0;
+	switch (colour_type)
+	{
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	default: return false;
+	}
+
+	std::vector<uint8_t> raw;
+	raw.reserve(static_cast<size_t>(width * channels + 1) * height);
+	if (!Inflater(compressed.data(), compressed.size()).run(raw))
+	{
+		return false;
+	}
+
+	size_t stride = static_cast<size_t>(width) * channels;
+	if (raw.size() < (stride + 1) * height)
+	{
+		return false;
+	}
+
+	// undo the filters in place, each row is preceded by its filter type
+	std::vector<uint8_t> previous(stride, 0);
+	std::vector<uint8_t> rows(stride * height);
+	for (int y = 0; y < height; y++)
+	{
+		auto filter = raw[y * (stride + 1)];
+		auto src = &raw[y * (stride + 1) + 1];
+		auto dst = &rows[y * stride];
+
+		for (size_t x = 0; x < stride; x++)
+		{
+			int left = x >= size_t(channels) ? dst[x - channels] : 0;
+			int up = previous[x];
+			int up_left = x >= size_t(channels) ? previous[x - channels] : 0;
+
+			switch (filter)
+			{
+			case 0: dst[x] = src[x]; break;
+			case 1: dst[x] = static_cast<uint8_t>(src[x] + left); break;
+			case 2: dst[x] = static_cast<uint8_t>(src[x] + up); break;
+			case 3: dst[x] = static_cast<uint8_t>(src[x] + ((left + up) >> 1)); break;
+			case 4: dst[x] = static_cast<uint8_t>(src[x] + paeth(left, up, up_left)); break;
+			default: return false;
+			}
+		}
+
+		std::memcpy(previous.data(), dst, stride);
+	}
+
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+	auto out = image.pixels.data();
+	for (size_t i = 0; i < size_t(width) * height; i++, out += 4)
+	{
+		auto in = &rows[i * channels];
+		switch (colour_type)
+		{
+		case 0:
+			out[0] = out[1] = out[2] = in[0];
+			out[3] = 255;
+			break;
+		case 2:
+			out[0] = in[0]; out[1] = in[1]; out[2] = in[2];
+			out[3] = 255;
+			break;
+		case 3:
+			if (size_t(in[0]) * 3 + 2 >= palette.size())
+			{
+				return false;
+			}
+			out[0] = palette[in[0] * 3];
+			out[1] = palette[in[0] * 3 + 1];
+			out[2] = palette[in[0] * 3 + 2];
+			out[3] = in[0] < transparency.size() ? transparency[in[0]] : 255;
+			break;
+		case 4:
+			out[0] = out[1] = out[2] = in[0];
+			out[3] = in[1];
+			break;
+		case 6:
+			std::memcpy(out, in, 4);
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool Png::load(const std::string& file_name, Image& image)
+{
+	std::vector<uint8_t> data;
+	return readFile(file_name, data) && decode(data.data(), data.size(), image);
+}
+
+bool Png::dimensions(const std::string& file_name, int& width, int& height)
+{
+	std::ifstream file(file_name, std::ios::binary);
+	uint8_t header[24];
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+		std::memcmp(header, SIGNATURE, 8) != 0 ||
+		std::memcmp(header + 12, "IHDR", 4) != 0)
+	{
+		return false;
+	}
+
+	width = static_cast<int>(readBigEndian(header + 16));
+	height = static_cast<int>(readBigEndian(header + 20));
+	return true;
+}
+
+/**
+*   @brief   Encodes an RGBA image.
+*   @details Rows are written unfiltered and the zlib stream uses
+			 stored blocks, trading file size for simplicity.
+*   @return  void
+*/
+void Png::encode(const Image& image, std::vector<uint8_t>& data)
+{
+	data.assign(SIGNATURE, SIGNATURE + 8);
+
+	uint8_t header[13];
+	auto put = [](uint8_t* at, uint32_t value)
+	{
+		at[0] = static_cast<uint8_t>(value >> 24);
+		at[1] = static_cast<uint8_t>(value >> 16);
+		at[2] = static_cast<uint8_t>(value >> 8);
+		at[3] = static_cast<uint8_t>(value);
+	};
+	put(header, image.width);
+	put(header + 4, image.height);
+	header[8] = 8;
+	header[9] = 6;
+	header[10] = header[11] = header[12] = 0;
+	writeChunk(data, "IHDR", header, sizeof(header));
+
+	size_t stride = static_cast<size_t>(image.width) * 4;
+	std::vector<uint8_t> raw;
+	raw.reserve((stride + 1) * image.height);
+	for (int y = 0; y < image.height; y++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), image.pixels.begin() + y * stride,
+			image.pixels.begin() + (y + 1) * stride);
+	}
+
+	std::vector<uint8_t> zlib = { 0x78, 0x01 };
+	size_t pos = 0;
+	do
+	{
+		auto len = std::min<size_t>(raw.size() - pos, 65535);
+		zlib.push_back(pos + len == raw.size() ? 1 : 0);
+		zlib.push_back(static_cast<uint8_t>(len));
+		zlib.push_back(static_cast<uint8_t>(len >> 8));
+		zlib.push_back(static_cast<uint8_t>(~len));
+		zlib.push_back(static_cast<uint8_t>(~len >> 8));
+		zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+		pos += len;
+	} while (pos < raw.size());
+	writeBigEndian(zlib, adler32(raw.data(), raw.size()));
+
+	writeChunk(data, "IDAT", zlib.data(), zlib.size());
+	writeChunk(data, "IEND", nullptr, 0);
+}
+
+bool Png::save(const std::string& file_name, const Image& image)
+{
+	std::vector<uint8_t> data;
+	encode(image, data);
+
+	std::ofstream file(file_name, std::ios::binary);
+	return file && file.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+*  A small, dependency free PNG reader and writer.
+*  Only what the asset tools and software renderers need is
+*  supported: 8 bit greyscale, grey-alpha, RGB, RGBA and palette
+*  images without interlacing. Everything is converted to, or
+*  written from, tightly packed 8 bit RGBA. Written images are
+*  stored without compression.
+*/
+namespace Png
+{
+	/**
+	*  A decoded image in 8 bit RGBA, rows top to bottom.
+	*/
+	struct Image
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	/**
+	*  Decodes a PNG file held in memory.
+	*  @param [in] data The encoded file.
+	*  @param [in] size The size of the encoded file in bytes.
+	*  @param [out] image The decoded image.
+	*  @return true if the file was decoded.
+	*/
+	bool decode(const uint8_t* data, size_t size, Image& image);
+
+	/**
+	*  Loads and decodes a PNG file.
+	*  @param [in] file_name The path of the file to load.
+	*  @param [out] image The decoded image.
+	*  @return true if the file was loaded and decoded.
+	*/
+	bool load(const std::string& file_name, Image& image);
+
+	/**
+	*  Reads a PNG file's dimensions without decoding it.
+	*  @param [in] file_name The path of the file to read.
+	*  @param [out] width The width of the image.
+	*  @param [out] height The height of the image.
+	*  @return true if the file has a valid PNG header.
+	*/
+	bool dimensions(const std::string& file_name, int& width, int& height);
+
+	/**
+	*  Encodes an RGBA image as a PNG file in memory.
+	*  @param [in] image The image to encode.
+	*  @param [out] data The encoded file.
+	*/
+	void encode(const Image& image, std::vector<uint8_t>& data);
+
+	/**
+	*  Encodes an RGBA image and writes it to a file.
+	*  @param [in] file_name The path of the file to write.
+	*  @param [in] image The image to encode.
+	*  @return true if the file was written.
+	*/
+	bool save(const std::string& file_name, const Image& image);
+}
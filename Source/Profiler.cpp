@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Profiler.h"
+
+namespace
+{
+	/**
+	*  Every thread's buffer, kept after the thread exits so its zones
+	*  can still be written. Also holds the point the clock is
+	*  calibrated from.
+	*/
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Profiler::ThreadBuffer>> buffers;
+		uint64_t start_ticks = Profiler::now();
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	};
+
+	Registry& registry()
+	{
+		static Registry instance;
+		return instance;
+	}
+
+	void writeEscaped(std::ostream& out, const char* text)
+	{
+		for (; *text; text++)
+		{
+			if (*text == '"' || *text == '\\')
+			{
+				out << '\\';
+			}
+			out << *text;
+		}
+	}
+
+	/**
+	*  Measures the clock against the system clock since start up,
+	*  waiting until enough time has passed to be accurate.
+	*/
+	double ticksPerMicrosecond(const Registry& registry)
+	{
+#if PROFILE_HAS_TSC
+		const auto MIN_SPAN = std::chrono::milliseconds(10);
+		while (std::chrono::steady_clock::now() - registry.start_time < MIN_SPAN)
+		{
+			std::this_thread::yield();
+		}
+
+		auto ticks = Profiler::now() - registry.start_ticks;
+		auto elapsed = std::chrono::duration<double, std::micro>(
+			std::chrono::steady_clock::now() - registry.start_time).count();
+		return ticks / elapsed;
+#else
+		(void)registry;
+		return 1000.0;
+#endif
+	}
+}
+
+namespace Profiler
+{
+	thread_local ThreadBuffer* local_buffer = nullptr;
+
+	ThreadBuffer& addThreadBuffer()
+	{
+		std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+		buffer->zones.resize(ThreadBuffer::CAPACITY);
+
+		auto& threads = registry();
+		std::lock_guard<std::mutex> lock(threads.mutex);
+		buffer->thread_id = static_cast<uint32_t>(threads.buffers.size()) + 1;
+		local_buffer = buffer.get();
+		threads.buffers.push_back(std::move(buffer));
+		return *local_buffer;
+	}
+
+	void setThreadName(const std::string& name)
+	{
+		auto& buffer = threadBuffer();
+		std::lock_guard<std::mutex> lock(registry().mutex);
+		buffer.thread_name = name;
+	}
+
+	/**
+	*   @brief   Writes the zones as a Chrome trace.
+	*   @details Each zone is a complete event, in microseconds from
+				 the earliest zone kept, on its thread's track.
+	*   @return  True if the file was written.
+	*/
+	bool writeChromeTrace(const std::string& file_name)
+	{
+		auto& threads = registry();
+		auto ticks_per_us = ticksPerMicrosecond(threads);
+
+		std::lock_guard<std::mutex> lock(threads.mutex);
+		uint64_t origin = UINT64_MAX;
+		for (const auto& buffer : threads.buffers)
+		{
+			auto count = buffer->count.load(std::memory_order_acquire);
+			auto first = count > ThreadBuffer::CAPACITY ? count - ThreadBuffer::CAPACITY : 0;
+			for (auto i = first; i < count; i++)
+			{
+				origin = std::min(origin, buffer->zones[i & (ThreadBuffer::CAPACITY - 1)].begin);
+			}
+		}
+
+		std::ofstream out(file_name);
+		out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		out.setf(std::ios::fixed);
+		out.precision(3);
+
+		bool first_event = true;
+		for (const auto& buffer : threads.buffers)
+		{
+			if (!buffer->thread_name.empty())
+			{
+				out << (first_event ? "" : ",")
+					<< "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+					<< buffer->thread_id << ",\"args\":{\"name\":\"";
+				writeEscaped(out, buffer->thread_name.c_str());
+				out << "\"}}";
+				first_event = false;
+			}
+
+			auto count = buffer->count.load(std::memory_order_acquire);
+			auto first = count > ThreadBuffer::CAPACITY ? count - ThreadBuffer::CAPACITY : 0;
+			for (auto i = first; i < count; i++)
+			{
+				const auto& zone = buffer->zones[i & (ThreadBuffer::CAPACITY - 1)];
+				out << (first_event ? "" : ",") << "\n{\"name\":\"";
+				writeEscaped(out, zone.name);
+				out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+					<< ",\"ts\":" << (zone.begin - origin) / ticks_per_us
+					<< ",\"dur\":" << (zone.end - zone.begin) / ticks_per_us << "}";
+				first_event = false;
+			}
+		}
+
+		out << "\n]}\n";
+		return static_cast<bool>(out);
+	}
+}
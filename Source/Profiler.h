@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define PROFILE_HAS_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define PROFILE_HAS_TSC 0
+#endif
+
+/**
+*  Records how long named parts of a frame take, for viewing as a
+*  Chrome trace (chrome://tracing, or ui.perfetto.dev).
+*
+*  Zones are only compiled in when PROFILING is defined; otherwise
+*  PROFILE_ZONE and PROFILE_THREAD expand to nothing. A zone's name
+*  must be a string literal, as only the pointer is kept. Each thread
+*  writes to its own ring buffer, so recording takes no locks. The
+*  buffers keep the most recent zones, and should be written out
+*  while the threads that record them are idle.
+*/
+#ifdef PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD(name)
+#endif
+
+namespace Profiler
+{
+	/**
+	*  A completed zone. Times are in ticks of the profiler's clock.
+	*/
+	struct Zone
+	{
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	/**
+	*  A thread's most recent zones.
+	*  Only the owning thread writes; the count is published after
+	*  each zone so readers see whole zones.
+	*/
+	struct ThreadBuffer
+	{
+		static const uint32_t CAPACITY = 1 << 16;
+
+		std::vector<Zone> zones;
+		std::atomic<uint64_t> count{ 0 };
+		uint32_t thread_id = 0;
+		std::string thread_name;
+	};
+
+	/**
+	*  Reads the profiler's clock. Uses the CPU's time stamp counter
+	*  where there is one, which is much cheaper than the system clock.
+	*  @return the current time in ticks.
+	*/
+	inline uint64_t now()
+	{
+#if PROFILE_HAS_TSC
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	/**
+	*  The calling thread's buffer, or null until it first records.
+	*/
+	extern thread_local ThreadBuffer* local_buffer;
+
+	/**
+	*  Creates and registers the calling thread's buffer.
+	*  @return the thread's new buffer.
+	*/
+	ThreadBuffer& addThreadBuffer();
+
+	/**
+	*  Returns the calling thread's buffer, creating it on first use.
+	*  @return the thread's buffer.
+	*/
+	inline ThreadBuffer& threadBuffer()
+	{
+		return local_buffer ? *local_buffer : addThreadBuffer();
+	}
+
+	/**
+	*  Names the calling thread in the trace.
+	*  @param [in] name The thread's name.
+	*/
+	void setThreadName(const std::string& name);
+
+	/**
+	*  Writes every thread's zones as Chrome trace event JSON.
+	*  @param [in] file_name The file to write.
+	*  @return true if the file was written.
+	*/
+	bool writeChromeTrace(const std::string& file_name);
+
+	/**
+	*  Records a zone in the calling thread's buffer.
+	*  @param [in] buffer The calling thread's buffer.
+	*  @param [in] name The zone's name.
+	*  @param [in] begin When the zone began, in ticks.
+	*  @param [in] end When the zone ended, in ticks.
+	*/
+	inline void record(ThreadBuffer& buffer, const char* name, uint64_t begin, uint64_t end)
+	{
+		auto count = buffer.count.load(std::memory_order_relaxed);
+		auto& zone = buffer.zones[count & (ThreadBuffer::CAPACITY - 1)];
+		zone.name = name;
+		zone.begin = begin;
+		zone.end = end;
+		buffer.count.store(count + 1, std::memory_order_release);
+	}
+}
+
+/**
+*  Times the scope it is declared in. Use through PROFILE_ZONE.
+*/
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name)
+		: buffer(Profiler::threadBuffer()), name(name), begin(Profiler::now())
+	{
+
+	}
+
+	~ProfileZone()
+	{
+		Profiler::record(buffer, name, begin, Profiler::now());
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	Profiler::ThreadBuffer& buffer;
+	const char* name;
+	uint64_t begin;
+};
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "RadixSort.h"
+
+namespace
+{
+	// below this std::sort beats clearing and summing the counts
+	const size_t RADIX_THRESHOLD = 1024;
+}
+
+/**
+*   @brief   Sorts keys with a byte wise radix sort.
+*   @details The counts for every sorted byte are gathered in one
+			 read of the keys. Each pass then scatters the keys by
+			 one byte into the other buffer, which keeps equal bytes
+			 in order. The result may end up in the scratch buffer,
+			 in which case the two are swapped.
+*   @return  void
+*/
+void radixSort(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch,
+	int payload_bits)
+{
+	const size_t count = keys.size();
+	const int first_byte = payload_bits / 8;
+
+	if (count < RADIX_THRESHOLD)
+	{
+		// an increasing payload orders equal keys as the radix sort would
+		std::sort(keys.begin(), keys.end());
+		return;
+	}
+
+	size_t counts[8][256] = {};
+	for (auto key : keys)
+	{
+		for (int byte = first_byte; byte < 8; byte++)
+		{
+			counts[byte][(key >> (byte * 8)) & 0xFF]++;
+		}
+	}
+
+	scratch.resize(count);
+	auto source = keys.data();
+	auto target = scratch.data();
+	for (int byte = first_byte; byte < 8; byte++)
+	{
+		auto& digit_counts = counts[byte];
+		auto shift = byte * 8;
+		if (digit_counts[(source[0] >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		size_t offsets[256];
+		size_t total = 0;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			offsets[digit] = total;
+			total += digit_counts[digit];
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			auto key = source[i];
+			target[offsets[(key >> shift) & 0xFF]++] = key;
+		}
+
+		std::swap(source, target);
+	}
+
+	if (source != keys.data())
+	{
+		keys.swap(scratch);
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+*  Sorts 64 bit keys into ascending order of their high bits.
+*  A least significant digit radix sort, a byte per pass, which takes
+*  time in proportion to the number of keys rather than n log n. The
+*  low bits are a payload, such as the index of the item the key
+*  belongs to. When the payload increases through the list, items
+*  with equal keys keep their original order.
+*
+*  Bytes that are the same in every key are skipped, so keys that only
+*  use a few of their bits sort in fewer passes. Short lists are
+*  sorted whole with std::sort, which is quicker than counting bytes
+*  for them.
+*  @param [in,out] keys The keys to sort.
+*  @param [in,out] scratch Working space, kept by the caller so it is
+*  allocated once.
+*  @param [in] payload_bits The number of low bits that are not sorted
+*  on, a multiple of 8.
+*/
+void radixSort(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch,
+	int payload_bits = 0);
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include "RectBatch.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define RECT_TARGET_AVX2
+#define RECT_TARGET_SSE2
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#define RECT_TARGET_AVX2 __attribute__((target("avx2")))
+#define RECT_TARGET_SSE2 __attribute__((target("sse2")))
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define RECT_HAS_X86 1
+#include <immintrin.h>
+#else
+#define RECT_HAS_X86 0
+#endif
+
+void RectArray::clear()
+{
+	x.clear();
+	y.clear();
+	length.clear();
+	height.clear();
+}
+
+void RectArray::reserve(size_t count)
+{
+	x.reserve(count);
+	y.reserve(count);
+	length.reserve(count);
+	height.reserve(count);
+}
+
+void RectArray::push_back(const rect& bounds)
+{
+	x.push_back(bounds.x);
+	y.push_back(bounds.y);
+	length.push_back(bounds.length);
+	height.push_back(bounds.height);
+}
+
+rect RectArray::operator[](size_t idx) const
+{
+	rect bounds;
+	bounds.x = x[idx];
+	bounds.y = y[idx];
+	bounds.length = length[idx];
+	bounds.height = height[idx];
+	return bounds;
+}
+
+size_t RectArray::size() const
+{
+	return x.size();
+}
+
+namespace
+{
+	/**
+	*   @brief   Tests rectangles one at a time.
+	*   @details Used as the fallback kernel and to finish off
+				 the elements left over by the wider kernels.
+	*   @return  void
+	*/
+	void overlapScalar(const rect& q, const RectArray& rects,
+		size_t first, uint64_t* hits)
+	{
+		auto q_right = q.x + q.length;
+		auto q_bottom = q.y + q.height;
+
+		for (size_t i = first; i < rects.size(); i++)
+		{
+			bool overlap =
+				q.x <= rects.x[i] + rects.length[i] && rects.x[i] <= q_right &&
+				q.y <= rects.y[i] + rects.height[i] && rects.y[i] <= q_bottom;
+
+			if (overlap)
+			{
+				hits[i / 64] |= uint64_t(1) << (i % 64);
+			}
+		}
+	}
+
+#if RECT_HAS_X86
+	/**
+	*   @brief   Tests four rectangles per iteration.
+	*   @return  The number of rectangles processed.
+	*/
+	RECT_TARGET_SSE2 size_t overlapSSE2(const rect& q, const RectArray& rects, uint64_t* hits)
+	{
+		const auto qx = _mm_set1_ps(q.x);
+		const auto qy = _mm_set1_ps(q.y);
+		const auto q_right = _mm_set1_ps(q.x + q.length);
+		const auto q_bottom = _mm_set1_ps(q.y + q.height);
+
+		auto count = rects.size() & ~size_t(3);
+		for (size_t i = 0; i < count; i += 4)
+		{
+			auto x = _mm_loadu_ps(&rects.x[i]);
+			auto y = _mm_loadu_ps(&rects.y[i]);
+			auto right = _mm_add_ps(x, _mm_loadu_ps(&rects.length[i]));
+			auto bottom = _mm_add_ps(y, _mm_loadu_ps(&rects.height[i]));
+
+			auto overlap = _mm_and_ps(
+				_mm_and_ps(_mm_cmple_ps(qx, right), _mm_cmple_ps(x, q_right)),
+				_mm_and_ps(_mm_cmple_ps(qy, bottom), _mm_cmple_ps(y, q_bottom)));
+
+			auto bits = static_cast<uint64_t>(_mm_movemask_ps(overlap));
+			hits[i / 64] |= bits << (i % 64);
+		}
+
+		return count;
+	}
+
+	/**
+	*   @brief   Tests eight rectangles per iteration.
+	*   @return  The number of rectangles processed.
+	*/
+	RECT_TARGET_AVX2 size_t overlapAVX2(const rect& q, const RectArray& rects, uint64_t* hits)
+	{
+		const auto qx = _mm256_set1_ps(q.x);
+		const auto qy = _mm256_set1_ps(q.y);
+		const auto q_right = _mm256_set1_ps(q.x + q.length);
+		const auto q_bottom = _mm256_set1_ps(q.y + q.height);
+
+		auto count = rects.size() & ~size_t(7);
+		for (size_t i = 0; i < count; i += 8)
+		{
+			auto x = _mm256_loadu_ps(&rects.x[i]);
+			auto y = _mm256_loadu_ps(&rects.y[i]);
+			auto right = _mm256_add_ps(x, _mm256_loadu_ps(&rects.length[i]));
+			auto bottom = _mm256_add_ps(y, _mm256_loadu_ps(&rects.height[i]));
+
+			auto overlap = _mm256_and_ps(
+				_mm256_and_ps(
+					_mm256_cmp_ps(qx, right, _CMP_LE_OQ),
+					_mm256_cmp_ps(x, q_right, _CMP_LE_OQ)),
+				_mm256_and_ps(
+					_mm256_cmp_ps(qy, bottom, _CMP_LE_OQ),
+					_mm256_cmp_ps(y, q_bottom, _CMP_LE_OQ)));
+
+			auto bits = static_cast<uint64_t>(_mm256_movemask_ps(overlap));
+			hits[i / 64] |= bits << (i % 64);
+		}
+
+		return count;
+	}
+
+	bool cpuHasAVX2()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+
+		// the OS must also save the AVX registers on a context switch
+		__cpuid(info, 1);
+		bool os_saves_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+			(_xgetbv(0) & 0x6) == 0x6;
+
+		__cpuidex(info, 7, 0);
+		return os_saves_avx && (info[1] & (1 << 5));
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	bool cpuHasSSE2()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#else
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+#endif
+}
+
+RectKernels::Level RectKernels::detect()
+{
+#if RECT_HAS_X86
+	if (cpuHasAVX2())
+	{
+		return Level::AVX2;
+	}
+	if (cpuHasSSE2())
+	{
+		return Level::SSE2;
+	}
+#endif
+	return Level::SCALAR;
+}
+
+/**
+*   @brief   Runs a specific overlap kernel.
+*   @details The mask is cleared first, the SIMD kernels handle
+			 whole groups of rectangles and the scalar kernel
+			 finishes the remainder.
+*   @return  void
+*/
+void RectKernels::overlapMask(Level level, const rect& query,
+	const RectArray& rects, std::vector<uint64_t>& hits)
+{
+	hits.assign((rects.size() + 63) / 64, 0);
+
+	size_t done = 0;
+#if RECT_HAS_X86
+	if (level == Level::AVX2)
+	{
+		done = overlapAVX2(query, rects, hits.data());
+	}
+	else if (level == Level::SSE2)
+	{
+		done = overlapSSE2(query, rects, hits.data());
+	}
+#endif
+
+	overlapScalar(query, rects, done, hits.data());
+}
+
+/**
+*   @brief   Tests a rectangle against a batch.
+*   @details The CPU is only queried once, the result is cached
+			 in a function local static.
+*   @return  void
+*/
+void overlapMask(const rect& query, const RectArray& rects, std::vector<uint64_t>& hits)
+{
+	static const auto level = RectKernels::detect();
+	RectKernels::overlapMask(level, query, rects, hits);
+}
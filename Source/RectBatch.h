@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Rect.h"
+
+/**
+*  A structure of arrays holding many rectangles.
+*  Keeping each field in its own contiguous array allows the
+*  overlap tests to load several rectangles with a single SIMD
+*  instruction. The arrays are always kept the same size.
+*  @see overlapMask
+*/
+struct RectArray
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> length;
+	std::vector<float> height;
+
+	void   clear();
+	void   reserve(size_t count);
+	void   push_back(const rect& bounds);
+	rect   operator[](size_t idx) const;
+	size_t size() const;
+};
+
+/**
+*  Tests a rectangle against every rectangle in a batch.
+*  Produces the same results as calling rect::isInside for each
+*  rectangle in turn, for rectangles with non-negative sizes. The
+*  fastest kernel supported by the CPU (AVX2, SSE2 or scalar) is
+*  selected the first time the function is called.
+*  @param [in] query The rectangle to test with.
+*  @param [in] rects The rectangles to test against.
+*  @param [out] hits Resized and filled with one bit per rectangle.
+*               Bit i of word i / 64 is set when rect i overlaps.
+*/
+void overlapMask(const rect& query, const RectArray& rects, std::vector<uint64_t>& hits);
+
+/**
+*  Checks whether a rectangle's bit is set in a hit mask.
+*  @param [in] hits The mask produced by overlapMask.
+*  @param [in] idx The index of the rectangle in the batch.
+*  @return true if the rectangle overlapped the query.
+*/
+inline bool isHit(const std::vector<uint64_t>& hits, size_t idx)
+{
+	return (hits[idx / 64] >> (idx % 64)) & 1;
+}
+
+/**
+*  The kernels available to overlapMask.
+*  Exposed so the benchmarks can compare them directly.
+*/
+namespace RectKernels
+{
+	enum class Level
+	{
+		SCALAR = 0,
+		SSE2 = 1,
+		AVX2 = 2
+	};
+
+	/**
+	*  Returns the best kernel the CPU supports.
+	*  @return the level used by overlapMask.
+	*/
+	Level detect();
+
+	/**
+	*  Runs a specific kernel.
+	*  The caller must make sure the CPU supports the level.
+	*  @param [in] level The kernel to use.
+	*  @param [in] query The rectangle to test with.
+	*  @param [in] rects The rectangles to test against.
+	*  @param [out] hits One bit per rectangle.
+	*/
+	void overlapMask(Level level, const rect& query, const RectArray& rects, std::vector<uint64_t>& hits);
+}
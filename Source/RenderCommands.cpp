@@ -0,0 +1,490 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "LayerRenderer.h"
+#include "RadixSort.h"
+#include "RenderCommands.h"
+#include "TextRenderer.h"
+
+namespace
+{
+	// the area a sprite covers, allowing for its rotation
+	rect spriteBounds(const SpriteCommand& sprite)
+	{
+		rect bounds;
+		bounds.length = sprite.instance.width * sprite.scale;
+		bounds.height = sprite.instance.height * sprite.scale;
+		bounds.x = sprite.instance.x;
+		bounds.y = sprite.instance.y;
+
+		if (sprite.angle != 0)
+		{
+			auto radius = std::sqrt(bounds.length * bounds.length +
+				bounds.height * bounds.height) / 2;
+			bounds.x += bounds.length / 2 - radius;
+			bounds.y += bounds.height / 2 - radius;
+			bounds.length = radius * 2;
+			bounds.height = radius * 2;
+		}
+
+		return bounds;
+	}
+
+	bool sameDraw(const SpriteCommand& a, const SpriteCommand& b)
+	{
+		return a.sprite == b.sprite && a.angle == b.angle &&
+			a.scale == b.scale && a.flip == b.flip;
+	}
+
+	bool sameArea(const rect& a, const rect& b)
+	{
+		return a.x == b.x && a.y == b.y && a.length == b.length && a.height == b.height;
+	}
+
+	// sort key layout: draw layer, z, texture, then the command's index
+	const int LAYER_SHIFT = 56;
+	const int DEPTH_SHIFT = 40;
+	const int TEXTURE_SHIFT = 32;
+	const uint64_t INDEX_MASK = 0xFFFFFFFFu;
+	const uint8_t MAX_TEXTURE_ID = 0xFF;
+}
+
+/**
+*   @brief   Turns a depth into sort key bits.
+*   @details The top 16 bits of the float, flipped so they order as
+			 the float does, which keeps its sign, exponent and 7
+			 bits of mantissa.
+*   @return  The 16 bits.
+*/
+uint64_t depthBits(float z_order)
+{
+	uint32_t bits = 0;
+	std::memcpy(&bits, &z_order, sizeof(bits));
+	bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+	return bits >> 16;
+}
+
+void RenderCommandList::clear()
+{
+	order.clear();
+	sprite_commands.clear();
+	text_commands.clear();
+	text_buffer.clear();
+	layer_sprites.reset();
+	layer_removals.clear();
+	has_layer = false;
+	draw_layer = 0;
+}
+
+void RenderCommandList::setDrawLayer(uint8_t layer)
+{
+	draw_layer = layer;
+}
+
+void RenderCommandList::addSprite(const SpriteCommand& sprite)
+{
+	Command command;
+	command.index = sprite_commands.size();
+	order.push_back(command);
+
+	sprite_commands.push_back(sprite);
+	sprite_commands.back().draw_layer = draw_layer;
+	sprite_commands.back().texture_id = textureId(sprite.sprite);
+}
+
+void RenderCommandList::addText(const char* text, size_t length, int x, int y,
+	float scale, const ASGE::Colour& colour)
+{
+	TextCommand command;
+	command.offset = text_buffer.size();
+	command.length = length;
+	command.x = x;
+	command.y = y;
+	command.scale = scale;
+	command.colour[0] = colour.r;
+	command.colour[1] = colour.g;
+	command.colour[2] = colour.b;
+	command.draw_layer = draw_layer;
+	text_buffer.insert(text_buffer.end(), text, text + length);
+
+	Command entry;
+	entry.text = true;
+	entry.index = text_commands.size();
+	text_commands.push_back(command);
+	order.push_back(entry);
+}
+
+void RenderCommandList::addText(const char* text, int x, int y, const ASGE::Colour& colour)
+{
+	addText(text, std::strlen(text), x, y, 1.0f, colour);
+}
+
+void RenderCommandList::setFrameNumber(long long number)
+{
+	frame_number = number;
+}
+
+void RenderCommandList::setLayer(const rect& area,
+	const std::shared_ptr<const std::vector<SpriteCommand>>& sprites)
+{
+	layer_area = area;
+	layer_sprites = sprites;
+	has_layer = sprites != nullptr;
+}
+
+void RenderCommandList::removeLayerSprite(int key)
+{
+	layer_removals.push_back(key);
+}
+
+bool RenderCommandList::hasLayer() const
+{
+	return has_layer;
+}
+
+long long RenderCommandList::frameNumber() const
+{
+	return frame_number;
+}
+
+const rect& RenderCommandList::layerArea() const
+{
+	return layer_area;
+}
+
+const std::shared_ptr<const std::vector<SpriteCommand>>& RenderCommandList::layerSprites() const
+{
+	return layer_sprites;
+}
+
+const std::vector<int>& RenderCommandList::layerRemovals() const
+{
+	return layer_removals;
+}
+
+const std::vector<RenderCommandList::Command>& RenderCommandList::commands() const
+{
+	return order;
+}
+
+const std::vector<SpriteCommand>& RenderCommandList::sprites() const
+{
+	return sprite_commands;
+}
+
+const std::vector<TextCommand>& RenderCommandList::texts() const
+{
+	return text_commands;
+}
+
+const char* RenderCommandList::characters() const
+{
+	return text_buffer.data();
+}
+
+/**
+*   @brief   Numbers a texture.
+*   @details Textures are numbered from 1 as they are first seen.
+			 Past the key's limit they share the last number, which
+			 only costs batching.
+*   @return  The texture's number.
+*/
+uint8_t RenderCommandList::textureId(const ASGE::Sprite* texture)
+{
+	if (!texture)
+	{
+		return 0;
+	}
+
+	auto found = texture_ids.find(texture);
+	if (found != texture_ids.end())
+	{
+		return found->second;
+	}
+
+	if (texture_ids.size() + 1 >= MAX_TEXTURE_ID)
+	{
+		return MAX_TEXTURE_ID;
+	}
+
+	auto id = static_cast<uint8_t>(texture_ids.size() + 1);
+	texture_ids.emplace(texture, id);
+	return id;
+}
+
+void RenderCommandPlayer::setSortMode(ASGE::SpriteSortMode mode)
+{
+	sort_mode = mode;
+}
+
+/**
+*   @brief   Draws a frame's commands.
+*   @details The static layer is opaque, so it is drawn first. The
+			 other commands are sorted by their keys, then submitted
+			 in order, with each run of sprites that can share a
+			 draw gathered into one batch.
+*   @return  void
+*/
+void RenderCommandPlayer::play(ASGE::Renderer* renderer, const RenderCommandList& commands)
+{
+	if (commands.hasLayer())
+	{
+		playLayer(renderer, commands);
+	}
+
+	const auto& order = commands.commands();
+	const auto& sprites = commands.sprites();
+	const auto& texts = commands.texts();
+
+	keys.resize(order.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const auto& command = order[i];
+		keys[i] = i | (command.text ?
+			sortKey(texts[command.index].draw_layer, texts[command.index].z_order, 0) :
+			sortKey(sprites[command.index].draw_layer, sprites[command.index].instance.z_order,
+				sprites[command.index].texture_id));
+	}
+
+	radixSort(keys, sort_scratch, 32);
+
+	if (batches.empty())
+	{
+		batches.emplace_back();
+	}
+
+	auto& batch = batches[0];
+	batch.state = nullptr;
+	batch.instances.clear();
+	for (auto key : keys)
+	{
+		const auto& command = order[key & INDEX_MASK];
+		if (!command.text)
+		{
+			const auto& sprite = sprites[command.index];
+			if (!sprite.sprite)
+			{
+				continue;
+			}
+
+			if (batch.state && !sameDraw(*batch.state, sprite))
+			{
+				submit(renderer, batch);
+			}
+
+			batch.state = &sprite;
+			batch.instances.push_back(sprite.instance);
+			continue;
+		}
+
+		submit(renderer, batch);
+		const auto& text = texts[command.index];
+		renderText(renderer, commands.characters() + text.offset, text.length,
+			text.x, text.y, text.scale, ASGE::Colour(text.colour), text.z_order);
+	}
+
+	submit(renderer, batch);
+}
+
+void RenderCommandPlayer::release(ASGE::Renderer* renderer)
+{
+	auto layers = dynamic_cast<LayerRenderer*>(renderer);
+	if (layers && layer >= 0)
+	{
+		layers->destroyLayer(layer);
+	}
+
+	layer = -1;
+}
+
+/**
+*   @brief   Draws the static layer.
+*   @details The layer is rebuilt when it is given new sprites or its
+			 area changes. Otherwise only the areas of the sprites
+			 removed since the last frame are redrawn, so a frame
+			 where nothing was removed only copies the layer.
+*   @return  void
+*/
+void RenderCommandPlayer::playLayer(ASGE::Renderer* renderer, const RenderCommandList& commands)
+{
+	bool rebuilt = layer_sprites != commands.layerSprites();
+	if (rebuilt)
+	{
+		layer_sprites = commands.layerSprites();
+		layer_removed.assign(layer_sprites->size(), 0);
+	}
+	removeLayerSprites(commands.layerRemovals());
+
+	auto layers = dynamic_cast<LayerRenderer*>(renderer);
+	if (!layers)
+	{
+		layer_damage.clear();
+		drawLayerSprites(renderer, nullptr);
+		return;
+	}
+
+	if (layer >= 0 && !sameArea(layer_area, commands.layerArea()))
+	{
+		release(renderer);
+	}
+
+	if (layer < 0)
+	{
+		layer = layers->createLayer(commands.layerArea());
+		if (layer < 0)
+		{
+			drawLayerSprites(renderer, nullptr);
+			return;
+		}
+
+		layer_area = commands.layerArea();
+		rebuilt = true;
+	}
+
+	if (rebuilt)
+	{
+		layer_damage.clear();
+		layer_damage.add(layer_area);
+	}
+
+	for (const auto& region : layer_damage.regions())
+	{
+		layers->beginLayer(layer, region);
+		drawLayerSprites(renderer, &region);
+		layers->endLayer();
+	}
+
+	layer_damage.clear();
+	layers->renderLayer(layer);
+}
+
+/**
+*   @brief   Removes sprites from the static layer.
+*   @details The sprites are found by key. A list names every
+			 removal its frame has not yet seen drawn, so a sprite
+			 may be named again; it only marks its area once.
+*   @return  void
+*/
+void RenderCommandPlayer::removeLayerSprites(const std::vector<int>& keys)
+{
+	const auto& sprites = *layer_sprites;
+	for (auto key : keys)
+	{
+		auto found = std::lower_bound(sprites.begin(), sprites.end(), key,
+			[](const SpriteCommand& sprite, int value) { return sprite.key < value; });
+		if (found == sprites.end() || found->key != key)
+		{
+			continue;
+		}
+
+		auto index = static_cast<size_t>(found - sprites.begin());
+		if (!layer_removed[index])
+		{
+			layer_removed[index] = 1;
+			layer_damage.add(spriteBounds(*found));
+		}
+	}
+}
+
+/**
+*   @brief   Draws the static layer's sprites.
+*   @details Sprites sharing a texture and transform are gathered
+			 into one batch each, submitted with a single renderSprites
+			 call. Removed sprites are skipped, and given a region,
+			 only the sprites touching it are drawn.
+*   @return  void
+*/
+void RenderCommandPlayer::drawLayerSprites(ASGE::Renderer* renderer, const rect* region)
+{
+	for (auto& batch : batches)
+	{
+		batch.state = nullptr;
+		batch.instances.clear();
+	}
+
+	const auto& sprites = *layer_sprites;
+	size_t used = 0;
+	for (size_t i = 0; i < sprites.size(); i++)
+	{
+		const auto& sprite = sprites[i];
+		if (!sprite.sprite || layer_removed[i] ||
+			(region && !region->isInside(spriteBounds(sprite))))
+		{
+			continue;
+		}
+
+		size_t batch = 0;
+		while (batch < used && !sameDraw(*batches[batch].state, sprite))
+		{
+			batch++;
+		}
+
+		if (batch == used)
+		{
+			if (used == batches.size())
+			{
+				batches.emplace_back();
+			}
+
+			batches[used++].state = &sprite;
+		}
+
+		batches[batch].instances.push_back(sprite.instance);
+	}
+
+	for (size_t i = 0; i < used; i++)
+	{
+		submit(renderer, batches[i]);
+	}
+}
+
+/**
+*   @brief   Builds a command's sort key.
+*   @details Text has no texture, so takes texture id 0.
+*   @return  The key, with the index bits clear.
+*/
+uint64_t RenderCommandPlayer::sortKey(uint8_t draw_layer, float z_order, uint8_t texture_id)
+{
+	uint64_t key = static_cast<uint64_t>(draw_layer) << LAYER_SHIFT;
+	if (sort_mode == ASGE::SpriteSortMode::IMMEDIATE ||
+		sort_mode == ASGE::SpriteSortMode::DEFERRED)
+	{
+		return key;
+	}
+
+	key |= static_cast<uint64_t>(texture_id) << TEXTURE_SHIFT;
+	if (sort_mode == ASGE::SpriteSortMode::BACK_TO_FRONT)
+	{
+		key |= depthBits(z_order) << DEPTH_SHIFT;
+	}
+	else if (sort_mode == ASGE::SpriteSortMode::FRONT_TO_BACK)
+	{
+		key |= (0xFFFF - depthBits(z_order)) << DEPTH_SHIFT;
+	}
+
+	return key;
+}
+
+/**
+*   @brief   Draws a batch and empties it.
+*   @details The transform shared by the batch is set on the sprite
+			 holding the texture, which renderSprites reads it from.
+*   @return  void
+*/
+void RenderCommandPlayer::submit(ASGE::Renderer* renderer, Batch& batch)
+{
+	if (!batch.state || batch.instances.empty())
+	{
+		return;
+	}
+
+	const auto& state = *batch.state;
+	state.sprite->rotationInRadians(state.angle);
+	state.sprite->scale(state.scale);
+	state.sprite->setFlipFlags(state.flip);
+	renderSprites(renderer, *state.sprite, batch.instances.data(), batch.instances.size());
+
+	batch.state = nullptr;
+	batch.instances.clear();
+}
@@ -0,0 +1,246 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/Colours.h>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+#include "BatchRenderer.h"
+#include "DirtyRegions.h"
+#include "Rect.h"
+
+/**
+*  A sprite to draw: the sprite holding its texture, and everything
+*  else the draw needs, copied so the game can move on.
+*/
+struct SpriteCommand
+{
+	ASGE::Sprite* sprite = nullptr;           /**< Holds the texture drawn from. */
+	SpriteInstance instance;                  /**< Position, size, source and tint. */
+	float angle = 0;                          /**< Rotation in radians. */
+	float scale = 1;                          /**< Scale applied to the size. */
+	ASGE::Sprite::FlipFlags flip = ASGE::Sprite::NORMAL; /**< Texture flips. */
+	int key = 0;                              /**< Identifies a layer sprite between frames. */
+	uint8_t draw_layer = 0;                   /**< Drawn above lower layers, whatever its z. */
+	uint8_t texture_id = 0;                   /**< Numbered by the list, for sorting by texture. */
+};
+
+/**
+*  Text to draw, held in its list's character buffer.
+*/
+struct TextCommand
+{
+	size_t offset = 0;            /**< First character in the buffer. */
+	size_t length = 0;            /**< Number of characters. */
+	int x = 0;                    /**< Text position in the X axis. */
+	int y = 0;                    /**< Text position in the Y axis. */
+	float scale = 1;              /**< Scaling factor. */
+	float colour[3]{ 1,1,1 };     /**< Red, green and blue. */
+	float z_order = 0;            /**< Depth used by the sorting modes. */
+	uint8_t draw_layer = 0;       /**< Drawn above lower layers, whatever its z. */
+};
+
+/**
+*  Turns a depth into 16 bits that order as the depth does, for the
+*  depth part of a sort key.
+*  @param [in] z_order The depth.
+*  @return the bits, in the low 16 bits.
+*/
+uint64_t depthBits(float z_order);
+
+/**
+*  Everything drawn in one frame, recorded by update.
+*  Drawing from a list rather than the game's live sprites means the
+*  game can simulate the next frame while this one is drawn. Sprites
+*  and text are given a draw layer, and are ordered by layer before
+*  they are drawn, see RenderCommandPlayer.
+*
+*  A list may also describe one static layer, drawn beneath
+*  everything else. The layer's sprites are recorded once, when it is
+*  built, and shared by every list after; each list then names the
+*  sprites removed since, so only where they were is redrawn.
+*
+*  Each sprite's texture is numbered as it is added, so sorting by
+*  texture compares numbers rather than searching for the texture.
+*  The numbers are kept when the list is cleared, so a texture keeps
+*  its number from frame to frame.
+*
+*  Storage is kept when a list is cleared, so recording a frame does
+*  not allocate once the list has grown to fit.
+*/
+class RenderCommandList
+{
+public:
+
+	/**
+	*  An entry in the order commands were added.
+	*/
+	struct Command
+	{
+		bool text = false; /**< Whether the entry is text or a sprite. */
+		size_t index = 0;  /**< The text or sprite. */
+	};
+
+	/**
+	*  Empties the list, keeping its storage.
+	*/
+	void clear();
+
+	/**
+	*  Sets the draw layer of the sprites and text added after it.
+	*  @param [in] draw_layer The layer, from 0 to 255.
+	*/
+	void setDrawLayer(uint8_t draw_layer);
+
+	/**
+	*  Adds a sprite, on the current draw layer, numbering its texture.
+	*  @param [in] sprite The sprite to draw.
+	*/
+	void addSprite(const SpriteCommand& sprite);
+
+	/**
+	*  Adds text, on the current draw layer.
+	*  @param [in] text The characters, which are copied.
+	*  @param [in] length The number of characters.
+	*  @param [in] x The text position in the X axis.
+	*  @param [in] y The text starting position in the Y axis.
+	*  @param [in] scale Any scaling factor to apply.
+	*  @param [in] colour The colour to use for rendering.
+	*/
+	void addText(const char* text, size_t length, int x, int y,
+		float scale, const ASGE::Colour& colour);
+
+	/**
+	*  Adds null terminated text at its natural size.
+	*  @param [in] text The string, which is copied.
+	*  @param [in] x The text position in the X axis.
+	*  @param [in] y The text starting position in the Y axis.
+	*  @param [in] colour The colour to use for rendering.
+	*/
+	void addText(const char* text, int x, int y, const ASGE::Colour& colour);
+
+	/**
+	*  Numbers the frame, so whoever draws it can say which it was.
+	*  @param [in] number The frame's number.
+	*/
+	void setFrameNumber(long long number);
+
+	/**
+	*  Sets the static layer. A new set of sprites rebuilds the layer,
+	*  so the same sprites should be given every frame until then.
+	*  @param [in] area The part of the screen the layer covers.
+	*  @param [in] sprites The layer's sprites, in increasing key order.
+	*/
+	void setLayer(const rect& area, const std::shared_ptr<const std::vector<SpriteCommand>>& sprites);
+
+	/**
+	*  Removes a sprite from the static layer. Removals are kept by the
+	*  player, so need only be listed until a frame with them is drawn.
+	*  @param [in] key The key of the sprite removed.
+	*/
+	void removeLayerSprite(int key);
+
+	/**
+	*  Checks whether the list has a static layer.
+	*  @return true if a layer was set.
+	*/
+	bool hasLayer() const;
+
+	long long frameNumber() const;
+	const rect& layerArea() const;
+	const std::shared_ptr<const std::vector<SpriteCommand>>& layerSprites() const;
+	const std::vector<int>& layerRemovals() const;
+	const std::vector<Command>& commands() const;
+	const std::vector<SpriteCommand>& sprites() const;
+	const std::vector<TextCommand>& texts() const;
+	const char* characters() const;
+
+private:
+	uint8_t textureId(const ASGE::Sprite* texture);
+
+	std::vector<Command> order;
+	std::vector<SpriteCommand> sprite_commands;
+	std::vector<TextCommand> text_commands;
+	std::vector<char> text_buffer;
+	std::shared_ptr<const std::vector<SpriteCommand>> layer_sprites;
+	std::vector<int> layer_removals;
+	rect layer_area;
+	long long frame_number = 0;
+	std::unordered_map<const ASGE::Sprite*, uint8_t> texture_ids;
+	bool has_layer = false;
+	uint8_t draw_layer = 0;
+};
+
+/**
+*  Draws render command lists.
+*  Lives on the thread that renders, and keeps what must survive
+*  between frames: the static layer, its sprites and which of them
+*  have been removed.
+*
+*  Each command is given a 64 bit key, packing its draw layer, z and
+*  texture above its position in the list, and the keys are radix
+*  sorted. Commands are then submitted in layer order, ordered within
+*  a layer as the sort mode describes, and consecutive sprites that
+*  share a texture are drawn as one batch.
+*/
+class RenderCommandPlayer
+{
+public:
+
+	/**
+	*  Sets how commands are ordered within a draw layer.
+	*  IMMEDIATE and DEFERRED keep the order they were added in,
+	*  TEXTURE groups them by texture, and BACK_TO_FRONT and
+	*  FRONT_TO_BACK order them by z, then texture.
+	*  @param [in] mode The ordering. Defaults to BACK_TO_FRONT.
+	*/
+	void setSortMode(ASGE::SpriteSortMode mode);
+
+	/**
+	*  Draws a list.
+	*  On renderers with layers the static layer is kept, and only
+	*  where sprites were removed is redrawn. Otherwise its sprites
+	*  are drawn every frame.
+	*  @param [in] renderer The renderer to draw with.
+	*  @param [in] commands The frame to draw.
+	*/
+	void play(ASGE::Renderer* renderer, const RenderCommandList& commands);
+
+	/**
+	*  Frees the static layer.
+	*  @param [in] renderer The renderer the layer was created with.
+	*/
+	void release(ASGE::Renderer* renderer);
+
+private:
+
+	/**
+	*  Instances sharing a texture and transform, drawn in one call.
+	*/
+	struct Batch
+	{
+		const SpriteCommand* state = nullptr;
+		std::vector<SpriteInstance> instances;
+	};
+
+	uint64_t sortKey(uint8_t draw_layer, float z_order, uint8_t texture_id);
+	void playLayer(ASGE::Renderer* renderer, const RenderCommandList& commands);
+	void submit(ASGE::Renderer* renderer, Batch& batch);
+	void removeLayerSprites(const std::vector<int>& keys);
+	void drawLayerSprites(ASGE::Renderer* renderer, const rect* region);
+
+	int layer = -1;
+	rect layer_area;
+	std::shared_ptr<const std::vector<SpriteCommand>> layer_sprites;
+	std::vector<uint8_t> layer_removed;
+	DirtyRegions layer_damage;
+	std::vector<Batch> batches;
+
+	ASGE::SpriteSortMode sort_mode = ASGE::SpriteSortMode::BACK_TO_FRONT;
+	std::vector<uint64_t> keys;
+	std::vector<uint64_t> sort_scratch;
+};
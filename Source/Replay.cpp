@@ -0,0 +1,205 @@
+#include <cstring>
+#include <fstream>
+
+#include "Replay.h"
+
+void Replay::reset(uint32_t seed, double tick_ms, const SceneSettings& scene)
+{
+	session_seed = seed;
+	tick_length = tick_ms;
+	session_scene = scene;
+	recorded_inputs.clear();
+	hashes.clear();
+}
+
+void Replay::addInput(uint32_t tick, int key, int action, int mods, float offset)
+{
+	Input input;
+	input.tick = tick;
+	input.key = static_cast<int16_t>(key);
+	input.action = static_cast<int8_t>(action);
+	input.mods = static_cast<int8_t>(mods);
+	input.offset = offset;
+	recorded_inputs.push_back(input);
+}
+
+void Replay::addTick(uint64_t hash)
+{
+	hashes.push_back(fold(hash));
+}
+
+bool Replay::matches(size_t tick, uint64_t hash) const
+{
+	return tick < hashes.size() && hashes[tick] == fold(hash);
+}
+
+/**
+*   @brief   Writes the recording.
+*   @details The header, scene, inputs and hashes are written as
+			 they are laid out in memory, as the asset archive is.
+*   @return  True if every byte was written.
+*/
+bool Replay::save(const std::string& file_name) const
+{
+	ReplayFormat::Header header = {};
+	std::memcpy(header.magic, ReplayFormat::MAGIC, 4);
+	header.version = ReplayFormat::VERSION;
+	header.seed = session_seed;
+	header.input_count = static_cast<uint32_t>(recorded_inputs.size());
+	header.tick_count = static_cast<uint32_t>(hashes.size());
+	header.layout = static_cast<uint32_t>(session_scene.layout);
+	header.tick_ms = tick_length;
+
+	ReplayFormat::Scene scene;
+	scene.bricks = session_scene.bricks;
+	scene.balls = session_scene.balls;
+	scene.gems = session_scene.gems;
+	scene.falling_gems = session_scene.falling_gems;
+
+	std::ofstream file(file_name, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(&scene), sizeof(scene));
+	file.write(reinterpret_cast<const char*>(recorded_inputs.data()),
+		recorded_inputs.size() * sizeof(Input));
+	file.write(reinterpret_cast<const char*>(hashes.data()),
+		hashes.size() * sizeof(uint32_t));
+	return static_cast<bool>(file);
+}
+
+/**
+*   @brief   Reads a recording.
+*   @details The counts in the header are checked against the size
+			 of the file before anything is allocated, so a
+			 truncated or corrupt file is rejected. Version 1
+			 inputs are read with no offset into their tick, and
+			 files before version 3 get the default scene.
+*   @return  True if the recording was read.
+*/
+bool Replay::load(const std::string& file_name)
+{
+	std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+	auto length = static_cast<uint64_t>(file.tellg());
+	file.seekg(0);
+
+	ReplayFormat::Header header;
+	if (length < sizeof(header) ||
+		!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		std::memcmp(header.magic, ReplayFormat::MAGIC, 4) != 0 ||
+		header.version < 1 || header.version > ReplayFormat::VERSION)
+	{
+		return false;
+	}
+
+	SceneSettings settings;
+	auto scene_size = header.version >= 3 ? sizeof(ReplayFormat::Scene) : 0;
+	auto input_size = header.version == 1 ? sizeof(ReplayFormat::InputV1) : sizeof(Input);
+	if (!(header.tick_ms > 0) ||
+		header.layout > static_cast<uint32_t>(SceneSettings::Layout::SPARSE) ||
+		length - sizeof(header) != scene_size + uint64_t(header.input_count) * input_size +
+			uint64_t(header.tick_count) * sizeof(uint32_t))
+	{
+		return false;
+	}
+
+	if (header.version >= 3)
+	{
+		ReplayFormat::Scene scene;
+		if (!file.read(reinterpret_cast<char*>(&scene), sizeof(scene)))
+		{
+			return false;
+		}
+
+		settings.layout = static_cast<SceneSettings::Layout>(header.layout);
+		settings.bricks = scene.bricks;
+		settings.balls = scene.balls;
+		settings.gems = scene.gems;
+		settings.falling_gems = scene.falling_gems;
+	}
+
+	std::vector<Input> inputs(header.input_count);
+	std::vector<uint32_t> ticks(header.tick_count);
+	if (header.version == 1)
+	{
+		std::vector<ReplayFormat::InputV1> stored(header.input_count);
+		if (!file.read(reinterpret_cast<char*>(stored.data()), stored.size() * input_size))
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < stored.size(); i++)
+		{
+			inputs[i].tick = stored[i].tick;
+			inputs[i].key = stored[i].key;
+			inputs[i].action = stored[i].action;
+			inputs[i].mods = stored[i].mods;
+			inputs[i].offset = 0;
+		}
+	}
+	else if (!file.read(reinterpret_cast<char*>(inputs.data()), inputs.size() * input_size))
+	{
+		return false;
+	}
+
+	if (!file.read(reinterpret_cast<char*>(ticks.data()), ticks.size() * sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	session_seed = header.seed;
+	tick_length = header.tick_ms;
+	session_scene = settings;
+	recorded_inputs.swap(inputs);
+	hashes.swap(ticks);
+	return true;
+}
+
+uint32_t Replay::seed() const
+{
+	return session_seed;
+}
+
+double Replay::tickMs() const
+{
+	return tick_length;
+}
+
+const SceneSettings& Replay::scene() const
+{
+	return session_scene;
+}
+
+size_t Replay::tickCount() const
+{
+	return hashes.size();
+}
+
+const std::vector<Replay::Input>& Replay::inputs() const
+{
+	return recorded_inputs;
+}
+
+// only 32 bits of each hash are kept, which still makes a missed
+// difference very unlikely, and halves the size of the file
+uint32_t Replay::fold(uint64_t hash)
+{
+	return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+void StateHash::add(const void* data, size_t size)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+uint64_t StateHash::value() const
+{
+	return hash;
+}
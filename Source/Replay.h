@@ -0,0 +1,166 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SceneGenerator.h"
+
+/**
+*  The layout of a replay file. A header is followed by the scene's
+*  counts, the recorded inputs, in the order they were applied, then
+*  by one state hash per tick. Values are stored little endian.
+*  Version 1 files, recorded before inputs were timed within a tick,
+*  and version 2 files, recorded before the scene was stored, can
+*  still be read; both were played on the game's own level.
+*/
+namespace ReplayFormat
+{
+	const char MAGIC[4] = { 'B', 'R', 'P', 'L' };
+	const uint32_t VERSION = 3;
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t seed;        /**< Seeds the game's random number generator. */
+		uint32_t input_count;
+		uint32_t tick_count;
+		uint32_t layout;      /**< The scene's layout, 0 for rows before version 3. */
+		double tick_ms;       /**< The length of a tick. */
+	};
+
+	struct Scene
+	{
+		int32_t bricks;
+		int32_t balls;
+		int32_t gems;
+		int32_t falling_gems;
+	};
+
+	struct Input
+	{
+		uint32_t tick;        /**< The tick the input was applied before. */
+		int16_t key;
+		int8_t action;
+		int8_t mods;
+		float offset;         /**< How far into the tick it took effect, from 0 to 1. */
+	};
+
+	/** An input as version 1 files store it, taking effect at the tick's start. */
+	struct InputV1
+	{
+		uint32_t tick;
+		int16_t key;
+		int8_t action;
+		int8_t mods;
+	};
+
+	static_assert(sizeof(Header) == 32, "replay header must be 32 bytes");
+	static_assert(sizeof(Scene) == 16, "replay scene must be 16 bytes");
+	static_assert(sizeof(Input) == 12, "replay input must be 12 bytes");
+	static_assert(sizeof(InputV1) == 8, "version 1 replay input must be 8 bytes");
+}
+
+/**
+*  A recorded session.
+*  Play only depends on the seed, the scene, the tick length and the
+*  inputs, so running the same inputs on the same ticks in the same
+*  scene reproduces it exactly.
+*  The hash of the game's state after every tick is kept as well, so
+*  a replay can report the first tick where it went differently.
+*/
+class Replay
+{
+public:
+	using Input = ReplayFormat::Input;
+
+	/**
+	*  Starts a new recording, discarding anything held.
+	*  @param [in] seed The seed the session was started with.
+	*  @param [in] tick_ms The length of a tick in milliseconds.
+	*  @param [in] scene The settings the level was built from.
+	*/
+	void reset(uint32_t seed, double tick_ms, const SceneSettings& scene);
+
+	/**
+	*  Records an input.
+	*  @param [in] tick The tick the input is applied before.
+	*  @param [in] key The key.
+	*  @param [in] action Whether the key was pressed, repeated or released.
+	*  @param [in] mods The modifier keys held.
+	*  @param [in] offset How far into the tick the input took effect.
+	*/
+	void addInput(uint32_t tick, int key, int action, int mods, float offset);
+
+	/**
+	*  Records the state after a tick.
+	*  @param [in] hash The hash of the game's state.
+	*/
+	void addTick(uint64_t hash);
+
+	/**
+	*  Compares the state after a tick with the recording.
+	*  @param [in] tick The tick, counted from 0.
+	*  @param [in] hash The hash of the game's state.
+	*  @return true if the recording holds the same hash for the tick.
+	*/
+	bool matches(size_t tick, uint64_t hash) const;
+
+	/**
+	*  Writes the recording to a file.
+	*  @param [in] file_name The file to write.
+	*  @return true if the file was written.
+	*/
+	bool save(const std::string& file_name) const;
+
+	/**
+	*  Reads a recording from a file.
+	*  @param [in] file_name The file to read.
+	*  @return true if the file was read and is valid.
+	*/
+	bool load(const std::string& file_name);
+
+	uint32_t seed() const;
+	double tickMs() const;
+	const SceneSettings& scene() const;
+	size_t tickCount() const;
+	const std::vector<Input>& inputs() const;
+
+private:
+	static uint32_t fold(uint64_t hash);
+
+	uint32_t session_seed = 0;
+	double tick_length = 0;
+	SceneSettings session_scene;
+	std::vector<Input> recorded_inputs;
+	std::vector<uint32_t> hashes;
+};
+
+/**
+*  Builds a 64 bit FNV-1a hash of the values added to it.
+*  Values are hashed by their bytes, so floats only hash the same on
+*  builds that compute them the same way.
+*/
+class StateHash
+{
+public:
+	void add(const void* data, size_t size);
+
+	template <typename T>
+	void add(const T& value)
+	{
+		add(&value, sizeof(T));
+	}
+
+	template <typename T>
+	void add(const std::vector<T>& values)
+	{
+		add(values.data(), values.size() * sizeof(T));
+	}
+
+	uint64_t value() const;
+
+private:
+	uint64_t hash = 14695981039346656037ull;
+};
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "SceneGenerator.h"
+
+namespace
+{
+	// the area the game's own rows start in, and the spacing between them
+	const float ROWS_LEFT = 20;
+	const float ROWS_TOP = 35;
+	const float ROWS_GAP = 10;
+
+	// the share of the screen's height a grid layout may fill
+	const float GRID_BOTTOM = 0.6f;
+
+	// sparse layouts place each brick in one of this many cells
+	const int SPARSE_CELLS_PER_BRICK = 4;
+	const float SPARSE_BRICK_SCALE = 0.8f;
+}
+
+/**
+*   @brief   Reads settings from text.
+*   @details Leaves the settings as they were if any part cannot be
+			 read. More falling gems than gems are cut down to all
+			 of them.
+*   @return  True if every part was read.
+*/
+bool SceneSettings::parse(const std::string& text)
+{
+	SceneSettings parsed = *this;
+
+	auto colon = text.find(':');
+	auto name = text.substr(0, colon);
+	if (name == "rows")
+	{
+		parsed.layout = Layout::ROWS;
+	}
+	else if (name == "dense")
+	{
+		parsed.layout = Layout::DENSE;
+	}
+	else if (name == "sparse")
+	{
+		parsed.layout = Layout::SPARSE;
+	}
+	else
+	{
+		return false;
+	}
+
+	int* counts[] = { &parsed.bricks, &parsed.balls, &parsed.gems, &parsed.falling_gems };
+	for (auto count : counts)
+	{
+		if (colon == std::string::npos)
+		{
+			break;
+		}
+
+		auto start = colon + 1;
+		colon = text.find(':', start);
+		auto part = text.substr(start, colon == std::string::npos ? std::string::npos : colon - start);
+
+		char* end = nullptr;
+		auto value = std::strtol(part.c_str(), &end, 10);
+		if (part.empty() || *end != '\0' || value < 0 || value > 100000000)
+		{
+			return false;
+		}
+		*count = static_cast<int>(value);
+	}
+
+	if (colon != std::string::npos || parsed.bricks < 1 || parsed.balls < 1 || parsed.gems < 1)
+	{
+		return false;
+	}
+
+	parsed.falling_gems = std::min(parsed.falling_gems, parsed.gems);
+	*this = parsed;
+	return true;
+}
+
+SceneGenerator::SceneGenerator(const SceneSettings& settings, float width, float height, uint32_t seed)
+	: settings(settings), width(width), height(height), random(seed)
+{
+
+}
+
+void SceneGenerator::layoutBricks(float brick_width, float brick_height, std::vector<SceneBrick>& bricks)
+{
+	bricks.clear();
+	bricks.reserve(settings.bricks);
+
+	if (settings.layout == SceneSettings::Layout::ROWS)
+	{
+		layoutRows(brick_width, brick_height, bricks);
+	}
+	else
+	{
+		layoutGrid(brick_width, brick_height,
+			settings.layout == SceneSettings::Layout::SPARSE, bricks);
+	}
+}
+
+void SceneGenerator::placeBall(rect& box, vector2& direction)
+{
+	box.x = uniform(0, width - box.length);
+	box.y = uniform(height * 0.65f, height - 120);
+
+	direction.x = uniform(-0.8f, 0.8f);
+	direction.y = -1;
+	direction.normalise();
+}
+
+void SceneGenerator::placeGem(rect& box)
+{
+	box.x = uniform(0, width - box.length);
+	box.y = uniform(-50, height / 2);
+}
+
+/**
+*   @brief   Lays out the game's own rows.
+*   @details Rows start below the top of the screen and wrap before
+			 the right edge. Colours alternate along a row, and the
+			 pattern flips on each row.
+*   @return  void
+*/
+void SceneGenerator::layoutRows(float brick_width, float brick_height, std::vector<SceneBrick>& bricks)
+{
+	float x = ROWS_LEFT;
+	float y = ROWS_TOP;
+	int row = 1;
+
+	for (int i = 0; i < settings.bricks; i++)
+	{
+		SceneBrick brick;
+		brick.bounds.x = x;
+		brick.bounds.y = y;
+		brick.bounds.length = brick_width;
+		brick.bounds.height = brick_height;
+		brick.alternate = (row % 2 == 0) != (i % 2 == 0);
+		bricks.push_back(brick);
+
+		x += brick_width + ROWS_GAP;
+		if (x + brick_width >= width)
+		{
+			row++;
+			x = ROWS_LEFT;
+			y = row * ROWS_TOP;
+		}
+	}
+}
+
+/**
+*   @brief   Lays out bricks on a grid over the top of the screen.
+*   @details The grid has a cell per brick when dense, or several
+			 when sparse. Cells keep the bricks' shape and are shrunk
+			 until the grid fits, but never grown past full size.
+			 Sparse bricks take a random choice of cells, each cell
+			 equally likely, and are smaller than their cells so
+			 they do not touch. Colours form a checkerboard.
+*   @return  void
+*/
+void SceneGenerator::layoutGrid(float brick_width, float brick_height, bool sparse,
+	std::vector<SceneBrick>& bricks)
+{
+	auto area_width = width - 2 * ROWS_LEFT;
+	auto area_height = height * GRID_BOTTOM - ROWS_TOP;
+	long long cells = static_cast<long long>(settings.bricks) * (sparse ? SPARSE_CELLS_PER_BRICK : 1);
+
+	double scale = std::min(1.0, std::sqrt(static_cast<double>(area_width) * area_height /
+		(static_cast<double>(cells) * brick_width * brick_height)));
+	auto columns = std::max(1LL, std::min(cells,
+		static_cast<long long>(area_width / (brick_width * scale))));
+	auto rows = (cells + columns - 1) / columns;
+	scale = std::min(scale, area_height / (static_cast<double>(rows) * brick_height));
+
+	auto cell_width = static_cast<float>(brick_width * scale);
+	auto cell_height = static_cast<float>(brick_height * scale);
+	auto size = sparse ? SPARSE_BRICK_SCALE : 1.0f;
+
+	long long needed = settings.bricks;
+	for (long long cell = 0; cell < cells && needed > 0; cell++)
+	{
+		// every remaining cell is as likely to be chosen as any other
+		if (sparse && static_cast<long long>(random() % (cells - cell)) >= needed)
+		{
+			continue;
+		}
+		needed--;
+
+		auto column = cell % columns;
+		auto row = cell / columns;
+
+		SceneBrick brick;
+		brick.bounds.length = cell_width * size;
+		brick.bounds.height = cell_height * size;
+		brick.bounds.x = ROWS_LEFT + column * cell_width + (cell_width - brick.bounds.length) / 2;
+		brick.bounds.y = ROWS_TOP + row * cell_height + (cell_height - brick.bounds.height) / 2;
+		brick.alternate = (column + row) % 2 != 0;
+		bricks.push_back(brick);
+	}
+}
+
+float SceneGenerator::uniform(float min, float max)
+{
+	return std::uniform_real_distribution<float>(min, std::max(min, max))(random);
+}
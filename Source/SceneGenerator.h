@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Rect.h"
+#include "Vector2.h"
+
+/**
+*  What a level is built from.
+*  The defaults are the game's own level: 48 bricks in rows, one ball
+*  and three gems waiting to spawn. Larger settings make stress scenes
+*  for finding where collision, drawing or memory stop scaling.
+*/
+struct SceneSettings
+{
+	enum class Layout
+	{
+		ROWS,     /**< Spaced rows of full size bricks, continuing below the screen. */
+		DENSE,    /**< Bricks packed edge to edge, shrunk to fit the top of the screen. */
+		SPARSE    /**< Bricks scattered over the top of the screen, a sixth of it covered. */
+	};
+
+	Layout layout = Layout::ROWS;
+	int bricks = 48;
+	int balls = 1;          /**< Including the player's ball. */
+	int gems = 3;
+	int falling_gems = 0;   /**< Gems already falling when play starts. */
+
+	/**
+	*  Reads settings written as layout:bricks[:balls[:gems[:falling]]],
+	*  for example dense:100000:1000:500:200. Counts left out keep
+	*  their current values.
+	*  @param [in] text The settings.
+	*  @return false if the text could not be read.
+	*/
+	bool parse(const std::string& text);
+};
+
+/**
+*  A brick placed by the generator.
+*/
+struct SceneBrick
+{
+	rect bounds;
+	bool alternate = false;   /**< Drawn in the second colour. */
+};
+
+/**
+*  Lays out levels from their settings.
+*  Layouts depend only on the settings, the play area and the seed,
+*  so the same level can be built again for a replay. The generator
+*  has its own random numbers, so building a level does not change
+*  the game's.
+*/
+class SceneGenerator
+{
+public:
+
+	/**
+	*  Constructor.
+	*  @param [in] settings The level to build.
+	*  @param [in] width The width of the play area.
+	*  @param [in] height The height of the play area.
+	*  @param [in] seed Seeds the generator's random numbers.
+	*/
+	SceneGenerator(const SceneSettings& settings, float width, float height, uint32_t seed);
+
+	/**
+	*  Lays out the bricks.
+	*  @param [in] brick_width The width of a full size brick.
+	*  @param [in] brick_height The height of a full size brick.
+	*  @param [out] bricks Cleared and filled with the bricks.
+	*/
+	void layoutBricks(float brick_width, float brick_height, std::vector<SceneBrick>& bricks);
+
+	/**
+	*  Chooses where a ball other than the player's starts, between
+	*  the bricks and the paddle, heading upwards at a random angle.
+	*  @param [in,out] box The ball's bounds, whose position is set.
+	*  @param [out] direction The ball's direction, of unit length.
+	*/
+	void placeBall(rect& box, vector2& direction);
+
+	/**
+	*  Chooses where a falling gem starts, somewhere above the middle
+	*  of the screen.
+	*  @param [in,out] box The gem's bounds, whose position is set.
+	*/
+	void placeGem(rect& box);
+
+private:
+	void layoutRows(float brick_width, float brick_height, std::vector<SceneBrick>& bricks);
+	void layoutGrid(float brick_width, float brick_height, bool sparse, std::vector<SceneBrick>& bricks);
+	float uniform(float min, float max);
+
+	SceneSettings settings;
+	float width = 0;
+	float height = 0;
+	std::minstd_rand random;
+};
@@ -1,4 +1,3 @@
-#include <Engine\Renderer.h>
 #include "SpriteComponent.h"
 
 SpriteComponent::~SpriteComponent()
@@ -7,26 +6,44 @@ SpriteComponent::~SpriteComponent()
 }
 
 bool SpriteComponent::loadSprite(
-	ASGE::Renderer* renderer, const std::string& texture_file_name)
+	TextureCache& textures, const std::string& texture_file_name)
 {
 	freeSprite();
-	sprite = renderer->createRawSprite();
-	if (sprite->loadTexture(texture_file_name))
+	sprite = textures.acquire(texture_file_name);
+	if (sprite)
 	{
+		texture_cache = &textures;
 		return true;
 	}
 
-	freeSprite();
 	return false;
 }
 
+bool SpriteComponent::loadSprite(
+	TextureAtlas& atlas, const std::string& frame_name)
+{
+	auto frame = atlas.find(frame_name);
+	if (!atlas.loaded() || !frame)
+	{
+		return loadSprite(atlas.cache(), atlas.looseFile(frame_name));
+	}
+
+	freeSprite();
+	atlas_sprite.reset(new AtlasSprite(atlas.sprite(), *frame));
+	sprite = atlas_sprite.get();
+	return true;
+}
+
 void SpriteComponent::freeSprite()
 {
-	if (sprite)
+	if (texture_cache)
 	{
-		delete sprite;
-		sprite = nullptr;
+		texture_cache->release(sprite);
+		texture_cache = nullptr;
 	}
+
+	atlas_sprite.reset();
+	sprite = nullptr;
 }
 
 
@@ -35,6 +52,56 @@ ASGE::Sprite* SpriteComponent::getSprite()
 	return sprite;
 }
 
+ASGE::Sprite* SpriteComponent::textureSprite() const
+{
+	return atlas_sprite ? atlas_sprite->atlasSprite() : sprite;
+}
+
+SpriteInstance SpriteComponent::instance() const
+{
+	SpriteInstance instance;
+	if (!sprite)
+	{
+		return instance;
+	}
+
+	instance.x = sprite->xPos();
+	instance.y = sprite->yPos();
+	instance.width = sprite->width();
+	instance.height = sprite->height();
+
+	const ASGE::Sprite& source = *sprite;
+	for (int i = 0; i < 4; i++)
+	{
+		instance.src_rect[i] = source.srcRect()[i];
+	}
+
+	auto colour = sprite->colour();
+	instance.tint[0] = colour.r;
+	instance.tint[1] = colour.g;
+	instance.tint[2] = colour.b;
+	instance.tint[3] = sprite->opacity();
+	return instance;
+}
+
+SpriteCommand SpriteComponent::command() const
+{
+	SpriteCommand command;
+	if (!sprite)
+	{
+		return command;
+	}
+
+	command.sprite = textureSprite();
+	command.instance = instance();
+	command.angle = sprite->rotationInRadians();
+	command.scale = sprite->scale();
+	command.flip = static_cast<ASGE::Sprite::FlipFlags>(
+		(sprite->isFlippedOnX() ? ASGE::Sprite::FLIP_X : 0) |
+		(sprite->isFlippedOnY() ? ASGE::Sprite::FLIP_Y : 0));
+	return command;
+}
+
 
 rect SpriteComponent::getBoundingBox() const
 {
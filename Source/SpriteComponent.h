@@ -1,6 +1,11 @@
 #pragma once
-#include <Engine\Sprite.h>
+#include <memory>
+#include <Engine/Sprite.h>
+#include "BatchRenderer.h"
 #include "Rect.h"
+#include "RenderCommands.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
 /**
 *  Sprite Components are used by GameObjects
 *  A component based approach allows GameObjects to decide
@@ -24,15 +29,28 @@ public:
 	~SpriteComponent();
 
 	/**
-	*  Allocates and loads the sprite.
-	*  Part of this process will attempt to load a texture file.
-	*  If this fails this function will return false and the memory
-	*  allocated, freed.
-	*  @param [in] renderer The renderer used to perform the allocations
+	*  Obtains the sprite from the texture cache.
+	*  Part of this process may load a texture file, which only
+	*  happens the first time a file is requested. If this fails
+	*  this function will return false. Components that load the
+	*  same file share a single sprite and texture.
+	*  @param [in] textures The cache the sprite is obtained from
 	*  @param [in] texture_file_name The file path to the the texture to load
 	*  @return true if the sprite was successfully loaded
 	*/
-	bool  loadSprite(ASGE::Renderer* renderer, const std::string& texture_file_name);
+	bool  loadSprite(TextureCache& textures, const std::string& texture_file_name);
+
+	/**
+	*  Creates a sprite showing one frame of a texture atlas.
+	*  The sprite has its own position and size but draws from the
+	*  atlas texture, so it must be drawn through command. If the atlas
+	*  is not loaded, or does not hold the frame, the image is loaded
+	*  from the atlas's loose folder instead.
+	*  @param [in] atlas The atlas holding the frame
+	*  @param [in] frame_name The image's file name without its extension
+	*  @return true if the sprite was successfully created
+	*/
+	bool  loadSprite(TextureAtlas& atlas, const std::string& frame_name);
 
 	/**
 	*  Returns a pointer to the sprite residing in this component.
@@ -42,6 +60,28 @@ public:
 	*/
 	ASGE::Sprite* getSprite();
 
+	/**
+	*  Returns the sprite whose texture this component draws with.
+	*  Atlas sprites all draw through their atlas's shared sprite, so
+	*  every frame of an atlas can be submitted in one batch.
+	*  @return the texture's sprite (if any)
+	*/
+	ASGE::Sprite* textureSprite() const;
+
+	/**
+	*  Describes the sprite as an instance for renderSprites.
+	*  @return the sprite's position, size, source rectangle and colour.
+	*/
+	SpriteInstance instance() const;
+
+	/**
+	*  Describes the sprite as a command for a RenderCommandList.
+	*  The command holds a copy of the sprite's state, so it can be
+	*  drawn while the sprite moves on.
+	*  @return the texture's sprite, the instance and its transform.
+	*/
+	SpriteCommand command() const;
+
 	/**
 	*  Grabs a bounding box for the sprite.
 	*  Will create a bounding box as a rectangle. This can be used to check
@@ -54,4 +94,6 @@ public:
 private:
 	void freeSprite();
 	ASGE::Sprite* sprite = nullptr;
+	TextureCache* texture_cache = nullptr;
+	std::unique_ptr<AtlasSprite> atlas_sprite;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "StepThread.h"
+
+StepThread::StepThread(std::function<void()> step)
+	: step(std::move(step)), thread(&StepThread::loop, this)
+{
+
+}
+
+StepThread::~StepThread()
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this] { return !pending; });
+		stopping = true;
+	}
+	started.notify_one();
+	thread.join();
+}
+
+void StepThread::run()
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this] { return !pending; });
+		pending = true;
+	}
+	started.notify_one();
+}
+
+void StepThread::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return !pending; });
+}
+
+bool StepThread::busy()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending;
+}
+
+void StepThread::loop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		started.wait(lock, [this] { return pending || stopping; });
+		if (stopping)
+		{
+			return;
+		}
+
+		lock.unlock();
+		step();
+		lock.lock();
+
+		pending = false;
+		finished.notify_all();
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+*  A thread that runs one step of work at a time, on request.
+*  Lets the caller overlap a step with its own work, such as
+*  simulating the next frame while the last one is drawn.
+*/
+class StepThread
+{
+public:
+
+	/**
+	*  Constructor. Starts the thread, which waits for a request.
+	*  @param [in] step The work to run for each request.
+	*/
+	explicit StepThread(std::function<void()> step);
+
+	/**
+	*  Destructor. Finishes the current step and stops the thread.
+	*/
+	~StepThread();
+
+	StepThread(const StepThread&) = delete;
+	StepThread& operator=(const StepThread&) = delete;
+
+	/**
+	*  Starts a step, once the previous one has finished.
+	*  Anything written before the call is visible to the step.
+	*/
+	void run();
+
+	/**
+	*  Waits for the current step to finish.
+	*  Anything the step wrote is visible once this returns.
+	*/
+	void wait();
+
+	/**
+	*  Checks whether a step is still running.
+	*  @return true until the current step finishes.
+	*/
+	bool busy();
+
+private:
+	void loop();
+
+	std::function<void()> step;
+	std::mutex mutex;
+	std::condition_variable started;
+	std::condition_variable finished;
+	bool pending = false;
+	bool stopping = false;
+	std::thread thread;
+};
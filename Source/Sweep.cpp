@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <limits>
+#include "Sweep.h"
+
+namespace
+{
+	/**
+	*   @brief   Computes entry and exit times along one axis.
+	*   @details A zero delta produces an infinite window when the
+				 ranges already overlap and an empty one otherwise.
+	*   @return  void
+	*/
+	void slab(float start, float size, float delta,
+		float target_start, float target_size, float& entry, float& exit)
+	{
+		const auto infinity = std::numeric_limits<float>::infinity();
+
+		// expand the target by the moving size so the mover is a point
+		auto low = target_start - size;
+		auto high = target_start + target_size;
+
+		if (delta == 0)
+		{
+			bool inside = start >= low && start <= high;
+			entry = inside ? -infinity : infinity;
+			exit = inside ? infinity : -infinity;
+			return;
+		}
+
+		auto t0 = (low - start) / delta;
+		auto t1 = (high - start) / delta;
+		entry = std::min(t0, t1);
+		exit = std::max(t0, t1);
+	}
+}
+
+/**
+*   @brief   Sweeps a rectangle against a stationary rectangle.
+*   @details The latest axis to start overlapping decides the face
+			 that was hit. A hit is only reported if the mover is
+			 heading into that face.
+*   @return  The impact, if any, within this move.
+*/
+SweepHit sweepRect(const rect& moving, const vector2& delta, const rect& target)
+{
+	SweepHit result;
+
+	float x_entry, x_exit, y_entry, y_exit;
+	slab(moving.x, moving.length, delta.x, target.x, target.length, x_entry, x_exit);
+	slab(moving.y, moving.height, delta.y, target.y, target.height, y_entry, y_exit);
+
+	auto entry = std::max(x_entry, y_entry);
+	auto exit = std::min(x_exit, y_exit);
+
+	// an empty window is a graze along an edge or corner, not an impact
+	if (entry >= exit || entry < 0 || entry > 1)
+	{
+		return result;
+	}
+
+	if (x_entry > y_entry)
+	{
+		result.normal.x = delta.x > 0 ? -1.0f : 1.0f;
+	}
+	else if (y_entry > x_entry)
+	{
+		result.normal.y = delta.y > 0 ? -1.0f : 1.0f;
+	}
+	else
+	{
+		result.normal.x = delta.x > 0 ? -1.0f : 1.0f;
+		result.normal.y = delta.y > 0 ? -1.0f : 1.0f;
+	}
+
+	// touching a face while moving away from it is not an impact
+	if (result.normal.x * delta.x + result.normal.y * delta.y >= 0)
+	{
+		result.normal = { 0,0 };
+		return result;
+	}
+
+	result.time = entry;
+	result.hit = true;
+	return result;
+}
+
+/**
+*   @brief   Sweeps a rectangle against the inside of an area.
+*   @details Each axis is checked against the wall the mover is
+			 heading towards and the earliest one wins.
+*   @return  The impact, if any, within this move.
+*/
+SweepHit sweepBounds(const rect& moving, const vector2& delta, const rect& bounds)
+{
+	SweepHit result;
+
+	auto wall = [&](float start, float size, float move,
+		float low, float high, float& time)
+	{
+		if (move < 0)
+		{
+			time = (low - start) / move;
+		}
+		else if (move > 0)
+		{
+			time = (high - (start + size)) / move;
+		}
+		else
+		{
+			return false;
+		}
+
+		// already past the wall counts as an immediate impact
+		time = std::max(time, 0.0f);
+		return time <= 1;
+	};
+
+	float x_time, y_time;
+	bool x_hit = wall(moving.x, moving.length, delta.x,
+		bounds.x, bounds.x + bounds.length, x_time);
+	bool y_hit = wall(moving.y, moving.height, delta.y,
+		bounds.y, bounds.y + bounds.height, y_time);
+
+	if (x_hit && (!y_hit || x_time <= y_time))
+	{
+		result.time = x_time;
+		result.normal.x = delta.x > 0 ? -1.0f : 1.0f;
+		result.hit = true;
+	}
+
+	if (y_hit && (!x_hit || y_time <= x_time))
+	{
+		result.time = y_time;
+		result.normal.y = delta.y > 0 ? -1.0f : 1.0f;
+		result.hit = true;
+	}
+
+	return result;
+}
+
+void reflect(vector2& direction, const vector2& normal)
+{
+	if (normal.x != 0)
+	{
+		direction.x *= -1;
+	}
+	if (normal.y != 0)
+	{
+		direction.y *= -1;
+	}
+}
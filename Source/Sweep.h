@@ -0,0 +1,50 @@
+#pragma once
+#include "Rect.h"
+#include "Vector2.h"
+
+/**
+*  The result of sweeping a rectangle through space.
+*  Time is expressed as a fraction of the movement, so 0 is the
+*  starting position and 1 the end of the move. The normal is
+*  the face of the target that was struck, pointing away from it.
+*/
+struct SweepHit
+{
+	float   time = 1;
+	vector2 normal = { 0,0 };
+	bool    hit = false;
+};
+
+/**
+*  Finds when a moving rectangle first touches a stationary one.
+*  Uses the slab method on the target expanded by the size of the
+*  moving rectangle. Targets the rectangle is already overlapping,
+*  only touching while moving away from, or merely grazing at a
+*  corner are not reported so a resolved impact is never detected
+*  twice.
+*  @param [in] moving The rectangle at the start of the move.
+*  @param [in] delta The distance moved on each axis.
+*  @param [in] target The rectangle to test against.
+*  @return the time of impact and face normal, if there is one.
+*/
+SweepHit sweepRect(const rect& moving, const vector2& delta, const rect& target);
+
+/**
+*  Finds when a moving rectangle leaves an enclosing area.
+*  Reports the first wall of the area the rectangle reaches, so
+*  the walls can be treated exactly like any other impact.
+*  @param [in] moving The rectangle at the start of the move.
+*  @param [in] delta The distance moved on each axis.
+*  @param [in] bounds The area the rectangle has to stay inside.
+*  @return the time of impact and wall normal, if there is one.
+*/
+SweepHit sweepBounds(const rect& moving, const vector2& delta, const rect& bounds);
+
+/**
+*  Reflects a direction off a surface.
+*  Axis aligned normals flip the matching component, a corner
+*  hit with both components set flips both.
+*  @param [in,out] direction The direction to reflect.
+*  @param [in] normal The normal of the surface that was hit.
+*/
+void reflect(vector2& direction, const vector2& normal);
@@ -0,0 +1,30 @@
+#include <cstring>
+#include <string>
+
+#include "TextRenderer.h"
+
+/**
+*   @brief   Draws characters, through TextRenderer where possible.
+*   @details Other renderers are given a std::string. Short strings,
+			 such as the HUD's, fit the string's own buffer and do
+			 not allocate.
+*   @return  void
+*/
+void renderText(ASGE::Renderer* renderer, const char* text, size_t length,
+	int x, int y, float scale, const ASGE::Colour& colour, float z_order)
+{
+	auto text_renderer = dynamic_cast<TextRenderer*>(renderer);
+	if (text_renderer)
+	{
+		text_renderer->renderText(text, length, x, y, scale, colour, z_order);
+		return;
+	}
+
+	renderer->renderText(std::string(text, length), x, y, scale, colour, z_order);
+}
+
+void renderText(ASGE::Renderer* renderer, const char* text,
+	int x, int y, const ASGE::Colour& colour)
+{
+	renderText(renderer, text, std::strlen(text), x, y, 1.0f, colour);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <Engine/Colours.h>
+#include <Engine/Renderer.h>
+
+/**
+*  Implemented by renderers that can draw text without a std::string.
+*  ASGE takes text as a std::string by value, so every string drawn
+*  is built and then copied. Renderers written for this game can also
+*  implement this interface, and draw straight from a character
+*  buffer. Use the renderText functions below, which fall back to
+*  building a string for renderers that do not implement it.
+*/
+class TextRenderer
+{
+public:
+	virtual ~TextRenderer() = default;
+
+	/**
+	*  Renders characters to the screen with the active font.
+	*  @param [in] text The characters to render.
+	*  @param [in] length The number of characters.
+	*  @param [in] x The text position in the X axis.
+	*  @param [in] y The text starting position in the Y axis.
+	*  @param [in] scale Any scaling factor to apply.
+	*  @param [in] colour The colour to use for rendering.
+	*  @param [in] z_order The z-ordering of the text.
+	*/
+	virtual void renderText(const char* text, size_t length, int x, int y,
+		float scale, const ASGE::Colour& colour, float z_order) = 0;
+};
+
+/**
+*  Renders characters, through TextRenderer where possible.
+*  @param [in] renderer The renderer to draw with.
+*  @param [in] text The characters to render.
+*  @param [in] length The number of characters.
+*  @param [in] x The text position in the X axis.
+*  @param [in] y The text starting position in the Y axis.
+*  @param [in] scale Any scaling factor to apply.
+*  @param [in] colour The colour to use for rendering.
+*  @param [in] z_order The z-ordering of the text.
+*/
+void renderText(ASGE::Renderer* renderer, const char* text, size_t length,
+	int x, int y, float scale, const ASGE::Colour& colour, float z_order = 0.0f);
+
+/**
+*  Renders a null terminated string, through TextRenderer where possible.
+*  @param [in] renderer The renderer to draw with.
+*  @param [in] text The string to render.
+*  @param [in] x The text position in the X axis.
+*  @param [in] y The text starting position in the Y axis.
+*  @param [in] colour The colour to use for rendering.
+*/
+void renderText(ASGE::Renderer* renderer, const char* text,
+	int x, int y, const ASGE::Colour& colour);
@@ -0,0 +1,134 @@
+#include <fstream>
+#include <sstream>
+
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+
+TextureAtlas::TextureAtlas(TextureCache& textures, const std::string& loose_directory)
+	: textures(textures), loose_directory(loose_directory)
+{
+
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	textures.release(atlas_sprite);
+}
+
+/**
+*   @brief   Reads the atlas manifest.
+*   @details The first line of the manifest names the texture and
+			 its size, each line after it describes one frame as
+			 "name x y width height".
+*   @return  True if the manifest was read.
+*/
+bool TextureAtlas::loadManifest(const std::string& manifest_file_name)
+{
+	frames.clear();
+	texture_file_name.clear();
+
+	std::ifstream manifest(manifest_file_name);
+	std::string line;
+	if (!std::getline(manifest, line))
+	{
+		return false;
+	}
+
+	std::istringstream header(line);
+	if (!(header >> texture_file_name))
+	{
+		return false;
+	}
+
+	while (std::getline(manifest, line))
+	{
+		std::istringstream fields(line);
+		std::string name;
+		Frame frame;
+		if (fields >> name >> frame.x >> frame.y >> frame.width >> frame.height)
+		{
+			frames[name] = frame;
+		}
+	}
+
+	auto slash = manifest_file_name.find_last_of("/\\");
+	if (slash != std::string::npos)
+	{
+		texture_file_name = manifest_file_name.substr(0, slash + 1) + texture_file_name;
+	}
+
+	return true;
+}
+
+bool TextureAtlas::loadTexture()
+{
+	textures.release(atlas_sprite);
+	atlas_sprite = nullptr;
+	if (texture_file_name.empty())
+	{
+		return false;
+	}
+
+	atlas_sprite = textures.acquire(texture_file_name);
+	return atlas_sprite != nullptr;
+}
+
+const std::string& TextureAtlas::textureFile() const
+{
+	return texture_file_name;
+}
+
+bool TextureAtlas::loaded() const
+{
+	return atlas_sprite != nullptr;
+}
+
+const TextureAtlas::Frame* TextureAtlas::find(const std::string& name) const
+{
+	auto found = frames.find(name);
+	return found == frames.end() ? nullptr : &found->second;
+}
+
+ASGE::Sprite* TextureAtlas::sprite() const
+{
+	return atlas_sprite;
+}
+
+TextureCache& TextureAtlas::cache() const
+{
+	return textures;
+}
+
+std::string TextureAtlas::looseFile(const std::string& name) const
+{
+	return loose_directory + name + ".png";
+}
+
+AtlasSprite::AtlasSprite(ASGE::Sprite* atlas, const TextureAtlas::Frame& frame)
+	: atlas(atlas)
+{
+	setFlipFlags(NORMAL);
+	width(frame.width);
+	height(frame.height);
+
+	auto source = srcRect();
+	source[0] = frame.x;
+	source[1] = frame.y;
+	source[2] = frame.width;
+	source[3] = frame.height;
+}
+
+bool AtlasSprite::loadTexture(const std::string&)
+{
+	return false;
+}
+
+const ASGE::Texture2D* AtlasSprite::getTexture() const
+{
+	return atlas->getTexture();
+}
+
+ASGE::Sprite* AtlasSprite::atlasSprite() const
+{
+	return atlas;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <Engine/Sprite.h>
+
+class TextureCache;
+
+/**
+*  A texture atlas built by the AtlasPacker tool.
+*  The atlas is a single texture holding many images, described by
+*  a manifest of named frames. Drawing every frame from the same
+*  texture lets the renderer batch them without texture switches.
+*  When the atlas can not be loaded the individual image files in
+*  the loose folder are used instead, see SpriteComponent.
+*/
+class TextureAtlas
+{
+public:
+
+	/**
+	*  The position of an image within the atlas, in pixels.
+	*/
+	struct Frame
+	{
+		float x = 0;
+		float y = 0;
+		float width = 0;
+		float height = 0;
+	};
+
+	/**
+	*  Constructor.
+	*  @param [in] textures The cache the atlas texture is obtained from.
+	*  @param [in] loose_directory The folder holding the individual images.
+	*/
+	TextureAtlas(TextureCache& textures, const std::string& loose_directory);
+
+	/**
+	*  Destructor. Releases the atlas texture.
+	*/
+	~TextureAtlas();
+
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	/**
+	*  Reads a manifest without loading the texture.
+	*  Allows the texture to be prefetched before calling loadTexture.
+	*  @param [in] manifest_file_name The file path to the manifest.
+	*  @return true if the manifest was read.
+	*/
+	bool loadManifest(const std::string& manifest_file_name);
+
+	/**
+	*  Loads the texture named by the manifest.
+	*  @return true if the texture loaded.
+	*/
+	bool loadTexture();
+
+	/**
+	*  Returns the path of the texture named by the manifest.
+	*  @return the atlas texture's file path, empty if no manifest is loaded.
+	*/
+	const std::string& textureFile() const;
+
+	/**
+	*  Checks whether the atlas is available.
+	*  @return true if loadTexture succeeded.
+	*/
+	bool loaded() const;
+
+	/**
+	*  Finds a frame by its image's name.
+	*  @param [in] name The image file name without its extension.
+	*  @return the frame, or nullptr if the atlas does not hold it.
+	*/
+	const Frame* find(const std::string& name) const;
+
+	/**
+	*  Returns the sprite holding the atlas texture.
+	*  It is shared by every frame and positioned just before drawing.
+	*  @return the atlas sprite, or nullptr if the atlas is not loaded.
+	*/
+	ASGE::Sprite* sprite() const;
+
+	/**
+	*  Returns the cache used to load textures.
+	*  @return the texture cache.
+	*/
+	TextureCache& cache() const;
+
+	/**
+	*  Builds the path of an image in the loose folder.
+	*  @param [in] name The image file name without its extension.
+	*  @return the file path to the individual image.
+	*/
+	std::string looseFile(const std::string& name) const;
+
+private:
+	TextureCache& textures;
+	std::string loose_directory;
+	std::string texture_file_name;
+	std::unordered_map<std::string, Frame> frames;
+	ASGE::Sprite* atlas_sprite = nullptr;
+};
+
+/**
+*  A sprite showing a single frame of a texture atlas.
+*  It stores its own position, size and appearance like any other
+*  sprite, but has no texture of its own. It is drawn by recording a
+*  command that names the atlas's shared sprite for the texture and
+*  carries this sprite's state, so the shared sprite is left alone.
+*/
+class AtlasSprite : public ASGE::Sprite
+{
+public:
+
+	/**
+	*  Constructor. The sprite starts at the frame's size.
+	*  @param [in] atlas The sprite holding the atlas texture.
+	*  @param [in] frame The part of the atlas to show.
+	*/
+	AtlasSprite(ASGE::Sprite* atlas, const TextureAtlas::Frame& frame);
+
+	/**
+	*  Atlas sprites can not load their own texture.
+	*  @return false
+	*/
+	bool loadTexture(const std::string&) override;
+
+	/**
+	*  Returns the atlas texture.
+	*  @return the texture shared by every frame of the atlas.
+	*/
+	const ASGE::Texture2D* getTexture() const override;
+
+	/**
+	*  Returns the shared sprite holding the atlas texture.
+	*  @return the atlas sprite.
+	*/
+	ASGE::Sprite* atlasSprite() const;
+
+private:
+	ASGE::Sprite* atlas = nullptr;
+};
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+#include <Engine/Texture.h>
+
+#include "AssetArchive.h"
+#include "MemoryTextureSprite.h"
+#include "TextureCache.h"
+
+TextureCache::TextureCache(ASGE::Renderer* renderer) : renderer(renderer)
+{
+	// every sprite a renderer creates is the same type, so one probe
+	// tells us whether textures can be loaded from memory
+	std::unique_ptr<ASGE::Sprite> probe(renderer->createRawSprite());
+	memory_sprites = dynamic_cast<MemoryTextureSprite*>(probe.get()) != nullptr;
+}
+
+TextureCache::~TextureCache()
+{
+	owners.clear();
+	entries.clear();
+}
+
+/**
+*   @brief   Gets the sprite holding a texture.
+*   @details On a miss the texture is loaded once.
+*   @return  The shared sprite, or nullptr if loading failed.
+*/
+ASGE::Sprite* TextureCache::acquire(const std::string& texture_file_name)
+{
+	auto key = normalise(texture_file_name);
+	auto shared = findShared(key);
+	if (shared)
+	{
+		return shared;
+	}
+
+	totals.misses++;
+	std::unique_ptr<ASGE::Sprite> sprite(renderer->createRawSprite());
+	if (!loadTexture(*sprite, texture_file_name))
+	{
+		return nullptr;
+	}
+
+	return addEntry(key, std::move(sprite), Png::Image());
+}
+
+/**
+*   @brief   Gets the sprite holding a texture, from decoded pixels.
+*   @details The sprite uses the pixels in place, so the image is
+			 moved into the entry, which keeps the pixels where they
+			 are, and lives as long as the texture.
+*   @return  The shared sprite, or nullptr if loading failed.
+*/
+ASGE::Sprite* TextureCache::acquire(const std::string& texture_file_name, Png::Image& image)
+{
+	auto key = normalise(texture_file_name);
+	auto shared = findShared(key);
+	if (shared)
+	{
+		return shared;
+	}
+
+	totals.misses++;
+	std::unique_ptr<ASGE::Sprite> sprite(renderer->createRawSprite());
+	auto memory = memory_sprites ? dynamic_cast<MemoryTextureSprite*>(sprite.get()) : nullptr;
+	if (memory && !image.pixels.empty() &&
+		memory->loadTextureFromMemory(image.pixels.data(), image.width, image.height))
+	{
+		totals.uploaded++;
+		return addEntry(key, std::move(sprite), std::move(image));
+	}
+
+	if (!loadTexture(*sprite, texture_file_name))
+	{
+		return nullptr;
+	}
+
+	return addEntry(key, std::move(sprite), Png::Image());
+}
+
+/**
+*   @brief   Releases a shared sprite.
+*   @details Unknown sprites are ignored, so releasing a sprite
+			 that was not obtained from this cache is harmless.
+*   @return  void
+*/
+void TextureCache::release(const ASGE::Sprite* sprite)
+{
+	auto owner = owners.find(sprite);
+	if (owner == owners.end())
+	{
+		return;
+	}
+
+	auto entry = owner->second;
+	if (--entry->references > 0)
+	{
+		return;
+	}
+
+	totals.textures--;
+	totals.bytes_resident -= entry->bytes;
+	owners.erase(owner);
+	entries.erase(entry->key);
+}
+
+void TextureCache::setArchive(const AssetArchive* asset_archive)
+{
+	archive = asset_archive;
+}
+
+bool TextureCache::isMapped(const std::string& texture_file_name) const
+{
+	return memory_sprites && archive && archive->find(texture_file_name);
+}
+
+/**
+*   @brief   Loads a texture into a new sprite.
+*   @details Prefers the archive's pre-decoded pixels, falling back
+			 to the image file if the archive does not hold it.
+*   @return  True if the texture loaded.
+*/
+bool TextureCache::loadTexture(ASGE::Sprite& sprite, const std::string& texture_file_name)
+{
+	auto memory = memory_sprites ? dynamic_cast<MemoryTextureSprite*>(&sprite) : nullptr;
+	auto image = archive ? archive->find(texture_file_name) : nullptr;
+	if (memory && image &&
+		memory->loadTextureFromMemory(image->pixels, image->width, image->height))
+	{
+		totals.mapped++;
+		return true;
+	}
+
+	return sprite.loadTexture(texture_file_name);
+}
+
+/**
+*   @brief   Finds a texture that is already loaded.
+*   @details Counts a hit and takes a reference when it is found.
+*   @return  The shared sprite, or nullptr if it is not loaded.
+*/
+ASGE::Sprite* TextureCache::findShared(const std::string& key)
+{
+	auto found = entries.find(key);
+	if (found == entries.end())
+	{
+		return nullptr;
+	}
+
+	totals.hits++;
+	found->second.references++;
+	return found->second.sprite.get();
+}
+
+/**
+*   @brief   Keeps a newly loaded texture.
+*   @details Its size is estimated from its dimensions and pixel
+			 format.
+*   @return  The shared sprite.
+*/
+ASGE::Sprite* TextureCache::addEntry(const std::string& key,
+	std::unique_ptr<ASGE::Sprite> sprite, Png::Image image)
+{
+	auto& entry = entries[key];
+	entry.sprite = std::move(sprite);
+	entry.image = std::move(image);
+	entry.key = key;
+	entry.references = 1;
+
+	auto texture = entry.sprite->getTexture();
+	if (texture)
+	{
+		entry.bytes = static_cast<size_t>(texture->getWidth()) *
+			texture->getHeight() * texture->getFormat();
+	}
+
+	owners[entry.sprite.get()] = &entry;
+	totals.textures++;
+	totals.bytes_resident += entry.bytes;
+
+	return entry.sprite.get();
+}
+
+TextureCache::Stats TextureCache::stats() const
+{
+	return totals;
+}
+
+/**
+*   @brief   Normalises a file path.
+*   @details Splits the path into segments, drops the redundant
+			 ones and joins them back together with forward slashes.
+			 Leading ".." segments of relative paths are kept.
+*   @return  The normalised path.
+*/
+std::string TextureCache::normalise(const std::string& path)
+{
+	bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+
+	std::vector<std::string> segments;
+	std::string segment;
+	for (size_t i = 0; i <= path.size(); i++)
+	{
+		if (i < path.size() && path[i] != '/' && path[i] != '\\')
+		{
+			segment += path[i];
+			continue;
+		}
+
+		if (segment == "..")
+		{
+			if (!segments.empty() && segments.back() != "..")
+			{
+				segments.pop_back();
+			}
+			else if (!absolute)
+			{
+				segments.push_back(segment);
+			}
+		}
+		else if (!segment.empty() && segment != ".")
+		{
+			segments.push_back(segment);
+		}
+
+		segment.clear();
+	}
+
+	std::string normalised = absolute ? "/" : "";
+	for (size_t i = 0; i < segments.size(); i++)
+	{
+		if (i > 0)
+		{
+			normalised += '/';
+		}
+		normalised += segments[i];
+	}
+
+#ifdef _WIN32
+	std::transform(normalised.begin(), normalised.end(), normalised.begin(),
+		[](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+
+	return normalised;
+}
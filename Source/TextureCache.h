@@ -0,0 +1,141 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Png.h"
+
+namespace ASGE {
+	class Renderer;
+	class Sprite;
+}
+
+class AssetArchive;
+
+/**
+*  A reference counted cache of loaded textures.
+*  ASGE only exposes textures through the sprite that loaded them,
+*  so the cache keeps one loaded sprite per texture file and hands
+*  that sprite to everyone who asks for the same file. Paths are
+*  normalised first, so different spellings of the same file share
+*  an entry. The texture is freed once its last user releases it.
+*  Sprites obtained from the cache are shared: users must position
+*  them immediately before drawing, as the entity sets do.
+*  When an asset archive is attached and the renderer's sprites can
+*  take pixels from memory, textures are mapped from the archive
+*  instead of being loaded from their files. Such sprites can also
+*  take images the caller has already decoded.
+*/
+class TextureCache
+{
+public:
+
+	/**
+	*  Running totals, useful for checking the cache is effective.
+	*/
+	struct Stats
+	{
+		size_t hits = 0;           /**< Requests served from the cache. */
+		size_t misses = 0;         /**< Requests that loaded a texture. */
+		size_t mapped = 0;         /**< Textures loaded from the asset archive. */
+		size_t uploaded = 0;       /**< Textures taken from decoded images. */
+		size_t textures = 0;       /**< Textures currently resident. */
+		size_t bytes_resident = 0; /**< Estimated memory used by resident textures. */
+	};
+
+	/**
+	*  Constructor.
+	*  @param [in] renderer The renderer used to create sprites.
+	*/
+	explicit TextureCache(ASGE::Renderer* renderer);
+
+	/**
+	*  Destructor. Frees any textures that are still resident.
+	*/
+	~TextureCache();
+
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	/**
+	*  Gets the sprite holding a texture, loading it if needed.
+	*  Every successful call must be paired with a call to release.
+	*  @param [in] texture_file_name The file path to the texture.
+	*  @return the shared sprite, or nullptr if the texture failed to load.
+	*/
+	ASGE::Sprite* acquire(const std::string& texture_file_name);
+
+	/**
+	*  Gets the sprite holding a texture, taking its pixels from an
+	*  image already decoded from the file if it is not yet loaded.
+	*  The pixels are kept by the cache for as long as the texture.
+	*  Sprites that cannot take pixels from memory, or an empty image,
+	*  load the texture as acquire does.
+	*  Every successful call must be paired with a call to release.
+	*  @param [in] texture_file_name The file path to the texture.
+	*  @param [in,out] image The image decoded from the file. Its
+	*  pixels are moved into the cache when they are used.
+	*  @return the shared sprite, or nullptr if the texture failed to load.
+	*/
+	ASGE::Sprite* acquire(const std::string& texture_file_name, Png::Image& image);
+
+	/**
+	*  Releases a sprite obtained from acquire.
+	*  The texture is freed when its last user releases it.
+	*  @param [in] sprite The sprite returned by acquire.
+	*/
+	void release(const ASGE::Sprite* sprite);
+
+	/**
+	*  Attaches an asset archive to load textures from.
+	*  The archive must outlive every texture loaded from it.
+	*  @param [in] asset_archive The open archive, or nullptr to detach it.
+	*/
+	void setArchive(const AssetArchive* asset_archive);
+
+	/**
+	*  Checks whether a texture would be mapped from the archive.
+	*  Such textures are cheap to load, as nothing is read or decoded.
+	*  @param [in] texture_file_name The file path to the texture.
+	*  @return true if the archive holds the texture and the renderer can use it.
+	*/
+	bool isMapped(const std::string& texture_file_name) const;
+
+	/**
+	*  Returns the cache's running totals.
+	*  @return the hit and miss counts and resident memory.
+	*/
+	Stats stats() const;
+
+	/**
+	*  Normalises a file path for use as a cache key.
+	*  Converts separators to forward slashes, removes empty and "."
+	*  segments and resolves "..". On Windows, where paths are not case
+	*  sensitive, the path is also lower cased.
+	*  @param [in] path The path to normalise.
+	*  @return the normalised path.
+	*/
+	static std::string normalise(const std::string& path);
+
+private:
+	struct Entry
+	{
+		std::unique_ptr<ASGE::Sprite> sprite;
+		Png::Image image;          /**< Pixels the texture uses, if uploaded. */
+		std::string key;
+		size_t bytes = 0;
+		int references = 0;
+	};
+
+	ASGE::Sprite* findShared(const std::string& key);
+	ASGE::Sprite* addEntry(const std::string& key, std::unique_ptr<ASGE::Sprite> sprite,
+		Png::Image image);
+	bool loadTexture(ASGE::Sprite& sprite, const std::string& texture_file_name);
+
+	ASGE::Renderer* renderer = nullptr;
+	const AssetArchive* archive = nullptr;
+	bool memory_sprites = false;
+	std::unordered_map<std::string, Entry> entries;
+	std::unordered_map<const ASGE::Sprite*, Entry*> owners;
+	Stats totals;
+};
@@ -0,0 +1,113 @@
+/**
+*  Packs every PNG below a folder into a single asset archive.
+*  Run as part of the build, after the texture atlas is generated:
+*
+*      ArchivePacker <resources folder> <archive>
+*
+*  Images are decoded here so the game never decodes them at run
+*  time. Entries are named by their path, starting with the name of
+*  the resources folder, which matches the relative paths the game
+*  loads textures with. See ArchiveFormat for the layout.
+*/
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "AssetArchive.h"
+#include "FileList.h"
+#include "Png.h"
+
+namespace
+{
+	std::string folderName(std::string path)
+	{
+		while (!path.empty() && (path.back() == '/' || path.back() == '\\'))
+		{
+			path.pop_back();
+		}
+
+		auto slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? path : path.substr(slash + 1);
+	}
+
+	uint64_t alignUp(uint64_t value)
+	{
+		return (value + ArchiveFormat::ALIGNMENT - 1) / ArchiveFormat::ALIGNMENT *
+			ArchiveFormat::ALIGNMENT;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		std::fprintf(stderr, "usage: ArchivePacker <resources folder> <archive>\n");
+		return 1;
+	}
+
+	std::string directory = argv[1];
+	auto prefix = folderName(directory) + "/";
+	auto files = listFiles(directory, ".png", true);
+
+	std::vector<ArchiveFormat::Entry> entries(files.size());
+	std::vector<Png::Image> images(files.size());
+	uint64_t offset = alignUp(sizeof(ArchiveFormat::Header) +
+		entries.size() * sizeof(ArchiveFormat::Entry));
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		auto name = prefix + files[i];
+		if (name.size() >= ArchiveFormat::NAME_LENGTH)
+		{
+			std::fprintf(stderr, "ArchivePacker: path too long %s\n", name.c_str());
+			return 1;
+		}
+
+		if (!Png::load(directory + "/" + files[i], images[i]))
+		{
+			std::fprintf(stderr, "ArchivePacker: could not read %s\n", files[i].c_str());
+			return 1;
+		}
+
+		auto& entry = entries[i];
+		std::memset(&entry, 0, sizeof(entry));
+		std::memcpy(entry.name, name.c_str(), name.size());
+		entry.offset = offset;
+		entry.width = static_cast<uint32_t>(images[i].width);
+		entry.height = static_cast<uint32_t>(images[i].height);
+		offset = alignUp(offset + images[i].pixels.size());
+	}
+
+	ArchiveFormat::Header header;
+	std::memcpy(header.magic, ArchiveFormat::MAGIC, 4);
+	header.version = ArchiveFormat::VERSION;
+	header.entry_count = static_cast<uint32_t>(entries.size());
+	header.reserved = 0;
+
+	std::ofstream archive(argv[2], std::ios::binary);
+	archive.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	archive.write(reinterpret_cast<const char*>(entries.data()),
+		entries.size() * sizeof(ArchiveFormat::Entry));
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		// pad up to the entry's aligned offset
+		auto position = static_cast<uint64_t>(archive.tellp());
+		std::vector<char> padding(static_cast<size_t>(entries[i].offset - position), 0);
+		archive.write(padding.data(), padding.size());
+		archive.write(reinterpret_cast<const char*>(images[i].pixels.data()),
+			images[i].pixels.size());
+	}
+
+	if (!archive)
+	{
+		std::fprintf(stderr, "ArchivePacker: could not write %s\n", argv[2]);
+		return 1;
+	}
+
+	std::printf("ArchivePacker: packed %zu images, %llu bytes\n",
+		entries.size(), static_cast<unsigned long long>(archive.tellp()));
+	return 0;
+}
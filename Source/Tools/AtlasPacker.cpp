@@ -0,0 +1,193 @@
+/**
+*  Packs a folder of PNG images into a single texture atlas.
+*  Run as part of the build, it writes the atlas image and a text
+*  manifest describing where each image was placed:
+*
+*      AtlasPacker <png folder> <atlas.png> <atlas.txt>
+*
+*  The manifest's first line names the atlas image and its size,
+*  every following line is "name x y width height", where name is
+*  the source file name without its extension.
+*/
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "FileList.h"
+#include "Png.h"
+
+namespace
+{
+	const int PADDING = 2;
+	const int MIN_WIDTH = 128;
+	const int MAX_WIDTH = 4096;
+
+	struct Entry
+	{
+		std::string name;
+		Png::Image image;
+		int x = 0;
+		int y = 0;
+	};
+
+	int nextPowerOfTwo(int value)
+	{
+		int result = 1;
+		while (result < value)
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+
+	/**
+	*  Places the entries on shelves, tallest first, and returns
+	*  the height used. Entries must already be sorted by height.
+	*/
+	int shelfPack(std::vector<Entry>& entries, int width)
+	{
+		int x = PADDING, y = PADDING, shelf_height = 0;
+		for (auto& entry : entries)
+		{
+			if (x + entry.image.width + PADDING > width)
+			{
+				x = PADDING;
+				y += shelf_height + PADDING;
+				shelf_height = 0;
+			}
+
+			entry.x = x;
+			entry.y = y;
+			x += entry.image.width + PADDING;
+			shelf_height = std::max(shelf_height, entry.image.height);
+		}
+
+		return y + shelf_height + PADDING;
+	}
+
+	/**
+	*  Copies an image into the atlas and repeats its border pixels
+	*  into the padding, so filtering at the edge of a frame never
+	*  samples its neighbour.
+	*/
+	void blit(Png::Image& atlas, const Entry& entry)
+	{
+		const auto& image = entry.image;
+		for (int y = -1; y <= image.height; y++)
+		{
+			int src_y = std::min(std::max(y, 0), image.height - 1);
+			for (int x = -1; x <= image.width; x++)
+			{
+				int src_x = std::min(std::max(x, 0), image.width - 1);
+				auto src = &image.pixels[(size_t(src_y) * image.width + src_x) * 4];
+				auto dst = &atlas.pixels[(size_t(entry.y + y) * atlas.width + entry.x + x) * 4];
+				std::memcpy(dst, src, 4);
+			}
+		}
+	}
+
+	std::string fileName(const std::string& path)
+	{
+		auto slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? path : path.substr(slash + 1);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 4)
+	{
+		std::fprintf(stderr, "usage: AtlasPacker <png folder> <atlas.png> <atlas.txt>\n");
+		return 1;
+	}
+
+	std::string directory = argv[1];
+	std::vector<Entry> entries;
+	int widest = 0;
+
+	for (const auto& file : listFiles(directory, ".png", false))
+	{
+		Entry entry;
+		entry.name = file.substr(0, file.size() - 4);
+		if (!Png::load(directory + "/" + file, entry.image))
+		{
+			std::fprintf(stderr, "AtlasPacker: could not read %s\n", file.c_str());
+			return 1;
+		}
+
+		widest = std::max(widest, entry.image.width);
+		entries.push_back(std::move(entry));
+	}
+
+	if (entries.empty())
+	{
+		std::fprintf(stderr, "AtlasPacker: no images found in %s\n", directory.c_str());
+		return 1;
+	}
+
+	std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+	{
+		return a.image.height > b.image.height;
+	});
+
+	// try each power of two width, keeping the atlas closest to square
+	// and then the smallest, as very long strips are poorly supported
+	int best_width = 0, best_height = 0;
+	for (int width = std::max(MIN_WIDTH, nextPowerOfTwo(widest + PADDING * 2));
+		width <= MAX_WIDTH; width <<= 1)
+	{
+		int height = nextPowerOfTwo(shelfPack(entries, width));
+		auto side = std::max(width, height), best_side = std::max(best_width, best_height);
+		if (!best_width || side < best_side ||
+			(side == best_side && size_t(width) * height < size_t(best_width) * best_height))
+		{
+			best_width = width;
+			best_height = height;
+		}
+	}
+
+	if (!best_width || best_height > MAX_WIDTH)
+	{
+		std::fprintf(stderr, "AtlasPacker: images do not fit in a %dx%d atlas\n",
+			MAX_WIDTH, MAX_WIDTH);
+		return 1;
+	}
+
+	shelfPack(entries, best_width);
+
+	Png::Image atlas;
+	atlas.width = best_width;
+	atlas.height = best_height;
+	atlas.pixels.assign(size_t(best_width) * best_height * 4, 0);
+	for (const auto& entry : entries)
+	{
+		blit(atlas, entry);
+	}
+
+	if (!Png::save(argv[2], atlas))
+	{
+		std::fprintf(stderr, "AtlasPacker: could not write %s\n", argv[2]);
+		return 1;
+	}
+
+	std::ofstream manifest(argv[3]);
+	manifest << fileName(argv[2]) << ' ' << atlas.width << ' ' << atlas.height << '\n';
+	for (const auto& entry : entries)
+	{
+		manifest << entry.name << ' ' << entry.x << ' ' << entry.y << ' '
+			<< entry.image.width << ' ' << entry.image.height << '\n';
+	}
+
+	if (!manifest)
+	{
+		std::fprintf(stderr, "AtlasPacker: could not write %s\n", argv[3]);
+		return 1;
+	}
+
+	std::printf("AtlasPacker: packed %zu images into a %dx%d atlas\n",
+		entries.size(), atlas.width, atlas.height);
+	return 0;
+}
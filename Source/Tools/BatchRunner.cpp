@@ -0,0 +1,347 @@
+/**
+*  Plays many independent headless sessions in parallel and reports
+*  on them together:
+*
+*      BreakoutBatch [sessions] [--threads n] [--seed n] [--minutes m]
+*                    [--input bot|random|idle] [--scaling]
+*
+*  Every session is its own BreakoutGame on the null renderer, with
+*  its own seed, so sessions share nothing that changes and a batch
+*  scales with the number of threads. Sessions run until the game is
+*  won or lost, or for the given minutes of play. The paddle is
+*  driven by a bot that follows the ball, by random key presses, or
+*  not at all. --scaling repeats the batch with 1 to n threads and
+*  charts the throughput of each.
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Engine/Keys.h>
+#include "Game.h"
+
+namespace
+{
+	const double FRAME_MS = 1000.0 / 60.0;
+
+	enum class InputMode
+	{
+		BOT,
+		RANDOM,
+		IDLE
+	};
+
+	struct SessionResult
+	{
+		uint32_t seed = 0;
+		bool loaded = false;
+		int score = 0;
+		int lives = 0;
+		int bricks_destroyed = 0;
+		bool won = false;
+		double play_seconds = 0;
+	};
+
+	struct BatchResult
+	{
+		std::vector<SessionResult> sessions;
+		unsigned threads = 0;
+		double wall_seconds = 0;
+	};
+
+	/**
+	*  Holds a key down, releasing it first if another is held, so
+	*  the game sees the same presses and releases as from a keyboard.
+	*/
+	void holdKey(BreakoutGame& game, int& held, int key)
+	{
+		if (held == key)
+		{
+			return;
+		}
+		if (held >= 0)
+		{
+			game.sendKey(held, ASGE::KEYS::KEY_RELEASED);
+		}
+		if (key >= 0)
+		{
+			game.sendKey(key, ASGE::KEYS::KEY_PRESSED);
+		}
+		held = key;
+	}
+
+	/**
+	*  Chooses the key to hold for the next frame.
+	*  The bot steers the centre of the paddle under the ball.
+	*/
+	int chooseKey(InputMode mode, const BreakoutGame::Status& status,
+		std::minstd_rand& random, int held)
+	{
+		if (mode == InputMode::BOT)
+		{
+			auto ball = status.ball.x + status.ball.length / 2;
+			auto paddle = status.paddle.x + status.paddle.length / 2;
+			auto dead_zone = status.paddle.length / 4;
+			if (ball < paddle - dead_zone)
+			{
+				return ASGE::KEYS::KEY_A;
+			}
+			if (ball > paddle + dead_zone)
+			{
+				return ASGE::KEYS::KEY_D;
+			}
+			return -1;
+		}
+
+		if (mode == InputMode::RANDOM && random() % 30 == 0)
+		{
+			const int keys[] = { ASGE::KEYS::KEY_A, ASGE::KEYS::KEY_D, -1 };
+			return keys[random() % 3];
+		}
+		return held;
+	}
+
+	/**
+	*  Plays one session from loading to the end of the game.
+	*  The game steps and runs its jobs on the calling thread alone;
+	*  more threads would only compete with the other sessions.
+	*/
+	SessionResult runSession(uint32_t seed, InputMode mode, double max_seconds)
+	{
+		SessionResult result;
+		result.seed = seed;
+
+		BreakoutGame game;
+		game.setSeed(seed);
+		game.setPipelined(false);
+		game.setJobThreads(1);
+		if (!game.init() || !game.finishLoading())
+		{
+			return result;
+		}
+		result.loaded = true;
+
+		game.tapKey(ASGE::KEYS::KEY_ENTER);
+		auto status = game.status();
+		auto bricks = status.bricks_left;
+
+		std::minstd_rand random(seed);
+		int held = -1;
+		auto max_frames = static_cast<long long>(max_seconds * 1000.0 / FRAME_MS);
+		for (long long frame = 0; frame < max_frames && !status.over; frame++)
+		{
+			holdKey(game, held, chooseKey(mode, status, random, held));
+			if (game.runFrames(1, FRAME_MS) == 0)
+			{
+				break;
+			}
+			status = game.status();
+		}
+
+		result.score = status.score;
+		result.lives = status.lives;
+		result.bricks_destroyed = bricks - status.bricks_left;
+		result.won = status.bricks_left <= 0;
+		result.play_seconds = status.ticks * FRAME_MS / 1000.0;
+		return result;
+	}
+
+	/**
+	*  Plays every session, spread across the threads.
+	*  Each thread takes the next session to run from a shared
+	*  counter and writes only that session's result.
+	*/
+	BatchResult runBatch(int session_count, unsigned threads, uint32_t first_seed,
+		InputMode mode, double max_seconds)
+	{
+		BatchResult batch;
+		batch.sessions.resize(session_count);
+		batch.threads = threads;
+
+		std::atomic<int> next_session{ 0 };
+		auto worker = [&]
+		{
+			for (int i = next_session++; i < session_count; i = next_session++)
+			{
+				batch.sessions[i] = runSession(first_seed + i, mode, max_seconds);
+			}
+		};
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> workers;
+		for (unsigned i = 1; i < threads; i++)
+		{
+			workers.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : workers)
+		{
+			thread.join();
+		}
+		batch.wall_seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+
+		return batch;
+	}
+
+	void report(const BatchResult& batch)
+	{
+		int loaded = 0, wins = 0, min_score = 0, max_score = 0;
+		double score = 0, lives = 0, bricks = 0, play_seconds = 0;
+		for (const auto& session : batch.sessions)
+		{
+			if (!session.loaded)
+			{
+				continue;
+			}
+			min_score = loaded ? std::min(min_score, session.score) : session.score;
+			max_score = loaded ? std::max(max_score, session.score) : session.score;
+			loaded++;
+			wins += session.won;
+			score += session.score;
+			lives += session.lives;
+			bricks += session.bricks_destroyed;
+			play_seconds += session.play_seconds;
+		}
+
+		auto sessions = static_cast<int>(batch.sessions.size());
+		std::printf("%d sessions on %u threads in %.3fs (%.1f sessions/s, %.0fx real time)\n",
+			sessions, batch.threads, batch.wall_seconds,
+			sessions / batch.wall_seconds, play_seconds / batch.wall_seconds);
+		if (loaded < sessions)
+		{
+			std::printf("%d sessions failed to load\n", sessions - loaded);
+		}
+		if (loaded == 0)
+		{
+			return;
+		}
+
+		std::printf("score:    mean %.0f, min %d, max %d\n", score / loaded, min_score, max_score);
+		std::printf("lives:    mean %.2f left, %d of %d sessions won\n", lives / loaded, wins, loaded);
+		std::printf("duration: mean %.1fs of play\n", play_seconds / loaded);
+		std::printf("bricks:   %.0f destroyed, %.2f per second of play\n",
+			bricks, play_seconds > 0 ? bricks / play_seconds : 0);
+	}
+
+	/**
+	*  Charts sessions per second against the thread count, with the
+	*  speedup over one thread and how close that is to linear.
+	*/
+	void reportScaling(const std::vector<BatchResult>& batches)
+	{
+		const int BAR_WIDTH = 50;
+		double best = 0;
+		for (const auto& batch : batches)
+		{
+			best = std::max(best, batch.sessions.size() / batch.wall_seconds);
+		}
+
+		auto single = batches.front().sessions.size() / batches.front().wall_seconds;
+		std::printf("\nthreads  sessions/s  speedup  efficiency\n");
+		for (const auto& batch : batches)
+		{
+			auto rate = batch.sessions.size() / batch.wall_seconds;
+			auto speedup = rate / single;
+			std::printf("%7u  %10.1f  %6.2fx  %9.0f%%  %s\n", batch.threads, rate, speedup,
+				100.0 * speedup / batch.threads,
+				std::string(static_cast<size_t>(BAR_WIDTH * rate / best + 0.5), '#').c_str());
+		}
+	}
+
+	/**
+	*  Reports an argument that could not be read, with the usage.
+	*  @param [in] problem What was wrong with the argument.
+	*  @param [in] argument The argument.
+	*  @return the exit code for bad arguments.
+	*/
+	int usage(const char* problem, const char* argument)
+	{
+		std::fprintf(stderr, "BreakoutBatch: %s %s\n", problem, argument);
+		std::fprintf(stderr, "usage: BreakoutBatch [sessions] [--threads n] [--seed n] [--minutes m]\n"
+			"                     [--input bot|random|idle] [--scaling]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int session_count = 1000;
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	uint32_t first_seed = 1;
+	double minutes = 5;
+	InputMode mode = InputMode::BOT;
+	bool scaling = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			first_seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--minutes") == 0 && i + 1 < argc)
+		{
+			minutes = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc)
+		{
+			i++;
+			if (std::strcmp(argv[i], "bot") == 0)
+			{
+				mode = InputMode::BOT;
+			}
+			else if (std::strcmp(argv[i], "random") == 0)
+			{
+				mode = InputMode::RANDOM;
+			}
+			else if (std::strcmp(argv[i], "idle") == 0)
+			{
+				mode = InputMode::IDLE;
+			}
+			else
+			{
+				return usage("unknown input", argv[i]);
+			}
+		}
+		else if (std::strcmp(argv[i], "--scaling") == 0)
+		{
+			scaling = true;
+		}
+		else
+		{
+			char* end = nullptr;
+			long count = std::strtol(argv[i], &end, 10);
+			if (end == argv[i] || *end != '\0' || count < 1 || count > INT32_MAX)
+			{
+				return usage("unknown argument", argv[i]);
+			}
+			session_count = static_cast<int>(count);
+		}
+	}
+
+	std::vector<BatchResult> batches;
+	for (unsigned count = scaling ? 1 : threads; count <= threads; count++)
+	{
+		batches.push_back(runBatch(session_count, count, first_seed, mode, minutes * 60));
+		report(batches.back());
+	}
+
+	if (scaling)
+	{
+		reportScaling(batches);
+	}
+
+	return 0;
+}
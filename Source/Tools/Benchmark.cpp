@@ -0,0 +1,999 @@
+/**
+*  Times the game's hot functions and whole frames, and writes the
+*  results as JSON so runs can be compared for regressions:
+*
+*      BreakoutBenchmark [--json file] [--filter text] [--min-time s]
+*
+*  Each benchmark is run enough times to take at least the minimum
+*  time, then timed over several samples; the median and fastest
+*  sample are reported per run. A benchmark's size is the number of
+*  items one run works through, or the bricks in the level for whole
+*  frames. Frames are played headless, so the benchmark must be run
+*  from the folder holding the game's Resources. A bot keeps the ball
+*  in play so every frame is of a game being played.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Engine/Keys.h>
+#include "EntitySet.h"
+#include "Game.h"
+#include "GameObject.h"
+#include "Headless/Blend.h"
+#include "Headless/NullRenderer.h"
+#include "Hud.h"
+#include "Profiler.h"
+#include "RadixSort.h"
+#include "Rect.h"
+#include "RectBatch.h"
+#include "RenderCommands.h"
+#include "SpriteComponent.h"
+#include "TextureCache.h"
+#include "Vector2.h"
+
+namespace
+{
+	const double FRAME_MS = 1000.0 / 60.0;
+	const int SAMPLES = 5;
+	const size_t ITEMS = 1024;
+
+	/**
+	*  Named values a benchmark reports besides its time, per run.
+	*/
+	using Counters = std::vector<std::pair<std::string, double>>;
+
+	/**
+	*  Runs a benchmark the given number of times.
+	*  @return the seconds the runs took, excluding any set up, or a
+	*  negative number if it could not run.
+	*/
+	using Body = std::function<double(size_t iterations, Counters& counters)>;
+
+	struct Benchmark
+	{
+		std::string name;
+		size_t size = 0;
+		Body body;
+	};
+
+	struct Result
+	{
+		std::string name;
+		size_t size = 0;
+		size_t iterations = 0;  /**< Runs per sample. */
+		double median_ns = 0;   /**< Per run. */
+		double min_ns = 0;      /**< Per run. */
+		Counters counters;
+	};
+
+	/**
+	*  Keeps the compiler from dropping work whose result is unused.
+	*/
+	volatile float sink = 0;
+
+	double secondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/**
+	*  Times a loop over a fixed set of items.
+	*  The items are made once, the loop visits them in turn.
+	*/
+	template <typename Item, typename Work>
+	Body loopOver(std::vector<Item> items, Work work)
+	{
+		auto shared = std::make_shared<std::vector<Item>>(std::move(items));
+		return [shared, work](size_t iterations, Counters&)
+		{
+			auto& all = *shared;
+			float total = 0;
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < iterations; i++)
+			{
+				total += work(all[i % all.size()]);
+			}
+			auto seconds = secondsSince(start);
+			sink = sink + total;
+			return seconds;
+		};
+	}
+
+	std::vector<vector2> makeVectors(size_t count)
+	{
+		std::vector<vector2> vectors;
+		for (size_t i = 0; i < count; i++)
+		{
+			vectors.emplace_back(static_cast<float>(i % 37) - 18.0f, static_cast<float>(i % 23) - 11.0f);
+		}
+		return vectors;
+	}
+
+	std::vector<rect> makeRects(size_t count)
+	{
+		std::vector<rect> rects(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			rects[i].x = static_cast<float>(i * 37 % 600);
+			rects[i].y = static_cast<float>(i * 53 % 900);
+			rects[i].length = static_cast<float>(20 + i % 60);
+			rects[i].height = static_cast<float>(10 + i % 30);
+		}
+		return rects;
+	}
+
+	void addMath(std::vector<Benchmark>& benchmarks)
+	{
+		benchmarks.push_back({ "vector2::normalise", ITEMS,
+			loopOver(makeVectors(ITEMS), [](vector2& vector)
+			{
+				vector.normalise();
+				return vector.x;
+			}) });
+
+		benchmarks.push_back({ "vector2::operator*", ITEMS,
+			loopOver(makeVectors(ITEMS), [](vector2& vector)
+			{
+				return (vector * 1.5f).y;
+			}) });
+
+		auto rects = makeRects(ITEMS);
+		benchmarks.push_back({ "rect::isInside(point)", ITEMS,
+			loopOver(rects, [](const rect& box)
+			{
+				return box.isInside(300.0f, 450.0f) ? 1.0f : 0.0f;
+			}) });
+
+		auto target = rects[ITEMS / 2];
+		benchmarks.push_back({ "rect::isInside(rect)", ITEMS,
+			loopOver(rects, [target](const rect& box)
+			{
+				return box.isInside(target) ? 1.0f : 0.0f;
+			}) });
+	}
+
+	/**
+	*  Times getBoundingBox on a sprite made by the null renderer.
+	*  The renderer and cache live as long as the benchmark.
+	*/
+	void addSprites(std::vector<Benchmark>& benchmarks)
+	{
+		struct Fixture
+		{
+			NullRenderer renderer;
+			std::unique_ptr<TextureCache> textures;
+			SpriteComponent sprite;
+		};
+
+		auto fixture = std::make_shared<Fixture>();
+		if (!fixture->renderer.init(640, 920, ASGE::Renderer::WindowMode::WINDOWED))
+		{
+			return;
+		}
+		fixture->textures.reset(new TextureCache(&fixture->renderer));
+		if (!fixture->sprite.loadSprite(*fixture->textures, "./Resources/Textures/puzzlepack/png/ballBlue.png"))
+		{
+			return;
+		}
+
+		std::vector<float> positions;
+		for (size_t i = 0; i < ITEMS; i++)
+		{
+			positions.push_back(static_cast<float>(i % 640));
+		}
+		benchmarks.push_back({ "SpriteComponent::getBoundingBox", ITEMS,
+			loopOver(positions, [fixture](float x)
+			{
+				fixture->sprite.getSprite()->xPos(x);
+				return fixture->sprite.getBoundingBox().x;
+			}) });
+	}
+
+	/**
+	*  Compares testing one box against every rectangle one at a time
+	*  with the batched kernels, at sizes from a level to far beyond.
+	*/
+	void addCollision(std::vector<Benchmark>& benchmarks)
+	{
+		const RectKernels::Level levels[] = {
+			RectKernels::Level::SCALAR, RectKernels::Level::SSE2, RectKernels::Level::AVX2 };
+		const char* names[] = { "overlapMask/scalar", "overlapMask/sse2", "overlapMask/avx2" };
+		auto best = RectKernels::detect();
+
+		for (size_t count : { 64, 4096, 1 << 20 })
+		{
+			auto rects = std::make_shared<RectArray>();
+			for (const auto& box : makeRects(count))
+			{
+				rects->push_back(box);
+			}
+			auto query = (*rects)[count / 2];
+
+			benchmarks.push_back({ "rect::isInside(rect) loop", count,
+				[rects, query](size_t iterations, Counters&)
+				{
+					size_t hits = 0;
+					auto start = std::chrono::steady_clock::now();
+					for (size_t i = 0; i < iterations; i++)
+					{
+						for (size_t r = 0; r < rects->size(); r++)
+						{
+							hits += (*rects)[r].isInside(query);
+						}
+					}
+					auto seconds = secondsSince(start);
+					sink = sink + hits;
+					return seconds;
+				} });
+
+			for (int level = 0; level <= static_cast<int>(best); level++)
+			{
+				benchmarks.push_back({ names[level], count,
+					[rects, query, level, levels](size_t iterations, Counters&)
+					{
+						std::vector<uint64_t> hits;
+						auto start = std::chrono::steady_clock::now();
+						for (size_t i = 0; i < iterations; i++)
+						{
+							RectKernels::overlapMask(levels[level], query, *rects, hits);
+						}
+						auto seconds = secondsSince(start);
+						sink = sink + hits.front();
+						return seconds;
+					} });
+			}
+		}
+	}
+
+	/**
+	*  Compares moving entities held in a set with moving the same
+	*  number of GameObjects the way blocks and gems were moved before
+	*  the sets replaced them: each object owns a sprite on the heap,
+	*  which is read, moved and written back, and its bounding box is
+	*  then gathered for collision.
+	*/
+	void addEntities(std::vector<Benchmark>& benchmarks)
+	{
+		const size_t COUNT = 100000;
+
+		struct Fixture
+		{
+			NullRenderer renderer;
+			std::unique_ptr<TextureCache> textures;
+			std::vector<GameObject> objects;
+		};
+
+		auto fixture = std::make_shared<Fixture>();
+		if (fixture->renderer.init(640, 920, ASGE::Renderer::WindowMode::WINDOWED))
+		{
+			fixture->textures.reset(new TextureCache(&fixture->renderer));
+			fixture->objects = std::vector<GameObject>(COUNT);
+
+			bool loaded = true;
+			auto boxes = makeRects(COUNT);
+			for (size_t i = 0; i < COUNT && loaded; i++)
+			{
+				auto& object = fixture->objects[i];
+				loaded = object.addSpriteComponent(*fixture->textures,
+					"./Resources/Textures/puzzlepack/png/ballBlue.png");
+				if (loaded)
+				{
+					object.spriteComponent()->getSprite()->xPos(boxes[i].x);
+					object.spriteComponent()->getSprite()->yPos(boxes[i].y);
+					object.set_vel_x(static_cast<int>(i % 7) - 3);
+					object.set_vel_y(static_cast<int>(i % 5) + 1);
+					object.visibility = true;
+				}
+			}
+
+			if (loaded)
+			{
+				benchmarks.push_back({ "GameObject update (before EntitySet)", COUNT,
+					[fixture](size_t iterations, Counters&)
+					{
+						const float dt = 1.0f / 60;
+						std::vector<rect> boxes;
+						auto start = std::chrono::steady_clock::now();
+						for (size_t i = 0; i < iterations; i++)
+						{
+							boxes.clear();
+							for (auto& object : fixture->objects)
+							{
+								if (!object.visibility)
+								{
+									continue;
+								}
+
+								auto sprite = object.spriteComponent()->getSprite();
+								sprite->xPos(sprite->xPos() + object.get_vel_x() * dt);
+								sprite->yPos(sprite->yPos() + object.get_vel_y() * dt);
+								boxes.push_back(object.spriteComponent()->getBoundingBox());
+							}
+						}
+						auto seconds = secondsSince(start);
+						sink = sink + boxes.front().y;
+						return seconds;
+					} });
+			}
+		}
+
+		auto entities = std::make_shared<EntitySet>();
+		for (const auto& box : makeRects(COUNT))
+		{
+			auto idx = entities->add(box, 0);
+			entities->vel_x[idx] = static_cast<float>(idx % 7) - 3;
+			entities->vel_y[idx] = static_cast<float>(idx % 5) + 1;
+		}
+
+		benchmarks.push_back({ "EntitySet::integrate", COUNT,
+			[entities](size_t iterations, Counters&)
+			{
+				auto start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < iterations; i++)
+				{
+					entities->integrate(1.0f / 60);
+				}
+				auto seconds = secondsSince(start);
+				sink = sink + entities->bounds.y[0];
+				return seconds;
+			} });
+	}
+
+	/**
+	*  Compares the radix sort with std::sort on keys built as the
+	*  renderer's are: a layer, depth and texture over a 32 bit index.
+	*  Lists shorter than these are sorted with std::sort by radixSort
+	*  itself. The keys are copied back before each run, which is not
+	*  timed.
+	*/
+	void addSorting(std::vector<Benchmark>& benchmarks)
+	{
+		for (size_t count : { 4096, 100000, 1000000 })
+		{
+			auto source = std::make_shared<std::vector<uint64_t>>(count);
+			std::minstd_rand random(1);
+			for (size_t i = 0; i < count; i++)
+			{
+				uint64_t layer = random() % 5;
+				uint64_t depth = depthBits(static_cast<float>(random() % 1000) / 10);
+				uint64_t texture = random() % 8;
+				(*source)[i] = (layer << 56) | (depth << 40) | (texture << 32) | i;
+			}
+
+			benchmarks.push_back({ "radixSort", count,
+				[source](size_t iterations, Counters&)
+				{
+					std::vector<uint64_t> keys, scratch;
+					double seconds = 0;
+					for (size_t i = 0; i < iterations; i++)
+					{
+						keys = *source;
+						auto start = std::chrono::steady_clock::now();
+						radixSort(keys, scratch, 32);
+						seconds += secondsSince(start);
+					}
+					sink = sink + keys.front();
+					return seconds;
+				} });
+
+			benchmarks.push_back({ "std::sort", count,
+				[source](size_t iterations, Counters&)
+				{
+					std::vector<uint64_t> keys;
+					double seconds = 0;
+					for (size_t i = 0; i < iterations; i++)
+					{
+						keys = *source;
+						auto start = std::chrono::steady_clock::now();
+						std::sort(keys.begin(), keys.end());
+						seconds += secondsSince(start);
+					}
+					sink = sink + keys.front();
+					return seconds;
+				} });
+		}
+	}
+
+	/**
+	*  Times blending a row of the game's width with each kernel the
+	*  processor supports.
+	*/
+	void addBlending(std::vector<Benchmark>& benchmarks)
+	{
+		const int WIDTH = 640;
+		for (auto kernel : { Blend::Kernel::SCALAR, Blend::Kernel::SSE2, Blend::Kernel::AVX2 })
+		{
+			if (!Blend::supported(kernel))
+			{
+				continue;
+			}
+
+			benchmarks.push_back({ std::string("Blend::span/") + Blend::name(kernel), WIDTH,
+				[kernel](size_t iterations, Counters&)
+				{
+					std::vector<uint32_t> dst(WIDTH, 0xff402010u), src(WIDTH);
+					for (int i = 0; i < WIDTH; i++)
+					{
+						src[i] = 0x01000000u * static_cast<uint32_t>(i % 256) | 0x00c08040u;
+					}
+					auto tint = Blend::makeTint(1.0f, 0.5f, 0.25f, 0.75f);
+
+					auto previous = Blend::kernel();
+					Blend::setKernel(kernel);
+					auto start = std::chrono::steady_clock::now();
+					for (size_t i = 0; i < iterations; i++)
+					{
+						Blend::span(dst.data(), src.data(), WIDTH, tint);
+					}
+					auto seconds = secondsSince(start);
+					Blend::setKernel(previous);
+
+					sink = sink + dst.front();
+					return seconds;
+				} });
+		}
+	}
+
+	/**
+	*  Times sorting and submitting a frame of sprites to the null
+	*  renderer, in each sort mode. The sprites use eight textures in
+	*  random order, over a few draw layers and depths. Reports the
+	*  draw calls each run makes.
+	*/
+	void addPlayback(std::vector<Benchmark>& benchmarks)
+	{
+		const size_t COUNT = 100000;
+		const char* files[] = { "ballBlue", "ballGrey",
+			"element_green_rectangle", "element_green_square",
+			"element_red_rectangle", "element_red_square",
+			"element_yellow_rectangle", "element_yellow_square" };
+
+		struct Fixture
+		{
+			NullRenderer renderer;
+			std::unique_ptr<TextureCache> textures;
+			std::vector<SpriteComponent> sprites;
+			RenderCommandList commands;
+		};
+
+		auto fixture = std::make_shared<Fixture>();
+		if (!fixture->renderer.init(640, 920, ASGE::Renderer::WindowMode::WINDOWED))
+		{
+			return;
+		}
+		fixture->textures.reset(new TextureCache(&fixture->renderer));
+		fixture->sprites = std::vector<SpriteComponent>(sizeof(files) / sizeof(files[0]));
+		for (size_t i = 0; i < fixture->sprites.size(); i++)
+		{
+			auto file = std::string("./Resources/Textures/puzzlepack/png/") + files[i] + ".png";
+			if (!fixture->sprites[i].loadSprite(*fixture->textures, file))
+			{
+				return;
+			}
+		}
+
+		std::minstd_rand random(1);
+		auto boxes = makeRects(COUNT);
+		for (size_t i = 0; i < COUNT; i++)
+		{
+			auto command = fixture->sprites[random() % fixture->sprites.size()].command();
+			command.instance.x = boxes[i].x;
+			command.instance.y = boxes[i].y;
+			command.instance.z_order = static_cast<float>(random() % 100) / 10;
+			fixture->commands.setDrawLayer(static_cast<uint8_t>(random() % 3));
+			fixture->commands.addSprite(command);
+		}
+
+		const ASGE::SpriteSortMode modes[] = {
+			ASGE::SpriteSortMode::IMMEDIATE, ASGE::SpriteSortMode::TEXTURE,
+			ASGE::SpriteSortMode::BACK_TO_FRONT, ASGE::SpriteSortMode::FRONT_TO_BACK };
+		const char* names[] = {
+			"RenderCommandPlayer/immediate", "RenderCommandPlayer/texture",
+			"RenderCommandPlayer/back to front", "RenderCommandPlayer/front to back" };
+
+		for (size_t mode = 0; mode < sizeof(modes) / sizeof(modes[0]); mode++)
+		{
+			auto sort_mode = modes[mode];
+			benchmarks.push_back({ names[mode], COUNT,
+				[fixture, sort_mode](size_t iterations, Counters& counters)
+				{
+					RenderCommandPlayer player;
+					player.setSortMode(sort_mode);
+
+					auto start = std::chrono::steady_clock::now();
+					for (size_t i = 0; i < iterations; i++)
+					{
+						fixture->renderer.preRender();
+						player.play(&fixture->renderer, fixture->commands);
+						fixture->renderer.postRender();
+					}
+					auto seconds = secondsSince(start);
+
+					counters = { { "draw_calls",
+						static_cast<double>(fixture->renderer.lastFrame().draw_calls) } };
+					return seconds;
+				} });
+		}
+	}
+
+	/**
+	*  Times recording the HUD with a score that changes every run, so
+	*  its text is laid out again each time.
+	*/
+	void addHud(std::vector<Benchmark>& benchmarks)
+	{
+		benchmarks.push_back({ "Hud::record", 3,
+			[](size_t iterations, Counters&)
+			{
+				Hud hud;
+				auto score = hud.addCounter("Score: ", 20, 900);
+				hud.addCounter("Lives: ", 20, 880);
+				hud.addCounter("Gem Chance: ", 20, 860);
+				RenderCommandList commands;
+
+				auto start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < iterations; i++)
+				{
+					commands.clear();
+					hud.set(score, static_cast<int>(i) * 1000);
+					hud.record(commands, ASGE::COLOURS::WHITE);
+				}
+				return secondsSince(start);
+			} });
+	}
+
+#ifdef PROFILING
+	/**
+	*  Times an empty profile zone. Only run when built with PROFILING
+	*  defined, as otherwise zones are compiled out.
+	*/
+	void addProfiler(std::vector<Benchmark>& benchmarks)
+	{
+		benchmarks.push_back({ "PROFILE_ZONE", 1,
+			[](size_t iterations, Counters&)
+			{
+				auto start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < iterations; i++)
+				{
+					PROFILE_ZONE("benchmark");
+				}
+				return secondsSince(start);
+			} });
+	}
+#endif
+
+	/**
+	*  How a game is set up to have its frames timed.
+	*/
+	struct FrameSetup
+	{
+		SceneSettings scene;
+		bool software = false;
+		int width = 0;
+		int height = 0;
+		bool pipelined = false;
+	};
+
+	/**
+	*  Steers the paddle under the ball, releasing the held key first
+	*  when changing direction.
+	*/
+	void steer(BreakoutGame& game, const BreakoutGame::Status& status, int& held)
+	{
+		auto ball = status.ball.x + status.ball.length / 2;
+		auto paddle = status.paddle.x + status.paddle.length / 2;
+		auto dead_zone = status.paddle.length / 4;
+		int key = ball < paddle - dead_zone ? ASGE::KEYS::KEY_A :
+			ball > paddle + dead_zone ? ASGE::KEYS::KEY_D : -1;
+
+		if (key == held)
+		{
+			return;
+		}
+		if (held >= 0)
+		{
+			game.sendKey(held, ASGE::KEYS::KEY_RELEASED);
+		}
+		if (key >= 0)
+		{
+			game.sendKey(key, ASGE::KEYS::KEY_PRESSED);
+		}
+		held = key;
+	}
+
+	/**
+	*  Makes a game, loads it and leaves the menu.
+	*  @return the game, or null if it failed to load.
+	*/
+	std::unique_ptr<BreakoutGame> startGame(const FrameSetup& setup)
+	{
+		std::unique_ptr<BreakoutGame> game(new BreakoutGame);
+		game->setSeed(1);
+		game->setPipelined(setup.pipelined);
+		if (!setup.pipelined)
+		{
+			game->setJobThreads(1);
+		}
+		game->setScene(setup.scene);
+		if (setup.software)
+		{
+			game->useBackend(HeadlessGame::Backend::SOFTWARE, setup.width, setup.height);
+		}
+
+		if (!game->init() || !game->finishLoading())
+		{
+			return nullptr;
+		}
+		game->tapKey(ASGE::KEYS::KEY_ENTER);
+		return game;
+	}
+
+	/**
+	*  Times whole frames: update, then drawing on the null or software
+	*  renderer. Only the frames themselves are timed, not making games
+	*  or steering the paddle. Once a game is won or lost, a new one is
+	*  started, so every frame timed is of play. Unless pipelined, the
+	*  game runs on one thread so the times are of the work alone.
+	*  Reports the draw calls and sprites of each frame.
+	*/
+	Body frames(const FrameSetup& setup)
+	{
+		return [setup](size_t iterations, Counters& counters)
+		{
+			std::unique_ptr<BreakoutGame> game;
+			NullRenderer::Stats before;
+			size_t draw_calls = 0, sprites = 0;
+			int held = -1;
+			double seconds = 0;
+
+			for (size_t i = 0; i < iterations; i++)
+			{
+				auto status = game ? game->status() : BreakoutGame::Status();
+				if (!game || status.over)
+				{
+					if (game)
+					{
+						draw_calls += game->stats().draw_calls - before.draw_calls;
+						sprites += game->stats().sprites - before.sprites;
+					}
+
+					game = startGame(setup);
+					if (!game)
+					{
+						return -1.0;
+					}
+					before = game->stats();
+					status = game->status();
+					held = -1;
+				}
+
+				steer(*game, status, held);
+				auto start = std::chrono::steady_clock::now();
+				game->runFrames(1, FRAME_MS);
+				seconds += secondsSince(start);
+			}
+
+			draw_calls += game->stats().draw_calls - before.draw_calls;
+			sprites += game->stats().sprites - before.sprites;
+			counters = {
+				{ "draw_calls", static_cast<double>(draw_calls) / iterations },
+				{ "sprites", static_cast<double>(sprites) / iterations } };
+			return seconds;
+		};
+	}
+
+	/**
+	*  Times making a game and loading it until it can be played.
+	*  The first run is the cold start: it is the first to load the
+	*  scene, and for the first benchmark, the first game in the
+	*  process. It is reported on its own, as first_ms, and left out of
+	*  the timed runs, so the median is of warm starts only.
+	*/
+	Body startup(const FrameSetup& setup)
+	{
+		auto first_ms = std::make_shared<double>(-1);
+		return [setup, first_ms](size_t iterations, Counters& counters)
+		{
+			if (*first_ms < 0)
+			{
+				auto start = std::chrono::steady_clock::now();
+				if (!startGame(setup))
+				{
+					return -1.0;
+				}
+				*first_ms = secondsSince(start) * 1000;
+			}
+
+			double seconds = 0;
+			for (size_t i = 0; i < iterations; i++)
+			{
+				auto start = std::chrono::steady_clock::now();
+				if (!startGame(setup))
+				{
+					return -1.0;
+				}
+				seconds += secondsSince(start);
+			}
+
+			counters = { { "first_ms", *first_ms } };
+			return seconds;
+		};
+	}
+
+	/**
+	*  Times skipping play with the event driven simulation, which
+	*  costs per impact rather than per tick. Nothing steers, so the
+	*  span should end before the game is over. Reports the impacts
+	*  of each run and the time per impact.
+	*/
+	Body fastForward(const FrameSetup& setup, double seconds)
+	{
+		return [setup, seconds](size_t iterations, Counters& counters)
+		{
+			double elapsed = 0;
+			size_t impacts = 0;
+			for (size_t i = 0; i < iterations; i++)
+			{
+				auto game = startGame(setup);
+				if (!game)
+				{
+					return -1.0;
+				}
+
+				auto start = std::chrono::steady_clock::now();
+				impacts += game->fastForward(seconds);
+				elapsed += secondsSince(start);
+			}
+
+			counters = {
+				{ "impacts", static_cast<double>(impacts) / iterations },
+				{ "ns_per_impact", impacts ? elapsed * 1e9 / impacts : 0.0 } };
+			return elapsed;
+		};
+	}
+
+	/**
+	*  Times playing the same span as fastForward a tick at a time,
+	*  with no steering. Each tick is a frame, so its time includes
+	*  recording and drawing the frame on the null renderer. Reports
+	*  the time per tick.
+	*/
+	Body ticked(const FrameSetup& setup, double seconds)
+	{
+		return [setup, seconds](size_t iterations, Counters& counters)
+		{
+			auto tick_count = static_cast<int>(seconds * 1000 / FRAME_MS);
+			double elapsed = 0;
+			for (size_t i = 0; i < iterations; i++)
+			{
+				auto game = startGame(setup);
+				if (!game)
+				{
+					return -1.0;
+				}
+
+				auto start = std::chrono::steady_clock::now();
+				game->runFrames(tick_count, FRAME_MS);
+				elapsed += secondsSince(start);
+			}
+
+			counters = { { "ns_per_tick", elapsed * 1e9 / (static_cast<double>(tick_count) * iterations) } };
+			return elapsed;
+		};
+	}
+
+	void addGame(std::vector<Benchmark>& benchmarks)
+	{
+		FrameSetup setup;
+		auto size = [&setup] { return static_cast<size_t>(setup.scene.bricks); };
+		benchmarks.push_back({ "BreakoutGame startup", size(), startup(setup) });
+
+		for (int bricks : { 48, 1000, 10000, 100000 })
+		{
+			setup.scene.bricks = bricks;
+			setup.scene.gems = std::max(3, bricks / 16);
+			benchmarks.push_back({ "BreakoutGame frame", size(), frames(setup) });
+		}
+
+		// stress scenes, of bricks packed on screen, many balls and gems
+		setup.scene.layout = SceneSettings::Layout::DENSE;
+		setup.scene.gems = 3;
+		for (int bricks : { 10000, 1000000 })
+		{
+			setup.scene.bricks = bricks;
+			benchmarks.push_back({ "BreakoutGame startup/dense", size(), startup(setup) });
+			benchmarks.push_back({ "BreakoutGame frame/dense", size(), frames(setup) });
+		}
+
+		setup.scene.layout = SceneSettings::Layout::SPARSE;
+		setup.scene.bricks = 100000;
+		benchmarks.push_back({ "BreakoutGame frame/sparse", size(), frames(setup) });
+
+		setup.scene.layout = SceneSettings::Layout::DENSE;
+		setup.scene.bricks = 10000;
+		setup.scene.balls = 1000;
+		benchmarks.push_back({ "BreakoutGame frame/dense 1000 balls", size(), frames(setup) });
+
+		setup.scene.layout = SceneSettings::Layout::ROWS;
+		setup.scene.bricks = 48;
+		setup.scene.balls = 1;
+		setup.scene.gems = 500;
+		setup.scene.falling_gems = 500;
+		benchmarks.push_back({ "BreakoutGame frame/500 falling gems", size(), frames(setup) });
+
+		// ten seconds ends before the ball is lost for good
+		setup.scene = SceneSettings();
+		benchmarks.push_back({ "BreakoutGame fast-forward 10s", size(), fastForward(setup, 10) });
+		benchmarks.push_back({ "BreakoutGame ticked 10s", size(), ticked(setup, 10) });
+
+		setup.pipelined = true;
+		benchmarks.push_back({ "BreakoutGame frame/pipelined", size(), frames(setup) });
+
+		setup.pipelined = false;
+		setup.software = true;
+		benchmarks.push_back({ "BreakoutGame frame/software 640x920", size(), frames(setup) });
+
+		setup.width = 3840;
+		setup.height = 2160;
+		benchmarks.push_back({ "BreakoutGame frame/software 3840x2160", size(), frames(setup) });
+	}
+
+	/**
+	*  Runs a benchmark until it takes the minimum time, raising the
+	*  runs each time, then times its samples.
+	*  @return false if the benchmark could not be run.
+	*/
+	bool measure(const Benchmark& benchmark, double min_seconds, Result& result)
+	{
+		size_t iterations = 1;
+		while (true)
+		{
+			auto seconds = benchmark.body(iterations, result.counters);
+			if (seconds < 0)
+			{
+				return false;
+			}
+			if (seconds >= min_seconds || iterations >= (size_t(1) << 40))
+			{
+				break;
+			}
+			iterations *= seconds > 0 ? std::min<size_t>(
+				static_cast<size_t>(min_seconds / seconds) + 1, 10) : 10;
+		}
+
+		std::vector<double> per_run;
+		for (int sample = 0; sample < SAMPLES; sample++)
+		{
+			per_run.push_back(benchmark.body(iterations, result.counters) * 1e9 / iterations);
+		}
+		std::sort(per_run.begin(), per_run.end());
+
+		result.name = benchmark.name;
+		result.size = benchmark.size;
+		result.iterations = iterations;
+		result.median_ns = per_run[per_run.size() / 2];
+		result.min_ns = per_run.front();
+		return true;
+	}
+
+	bool writeJson(const std::string& file_name, const std::vector<Result>& results)
+	{
+		auto out = std::fopen(file_name.c_str(), "w");
+		if (!out)
+		{
+			return false;
+		}
+
+		char date[32] = "";
+		auto now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+		std::fprintf(out, "{\n  \"context\": {\"date\": \"%s\", \"samples\": %d, \"build\": \"%s\"},\n",
+			date, SAMPLES,
+#ifdef NDEBUG
+			"release"
+#else
+			"debug"
+#endif
+		);
+		std::fprintf(out, "  \"benchmarks\": [");
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const auto& result = results[i];
+			std::fprintf(out, "%s\n    {\"name\": \"%s\", \"size\": %zu, \"iterations\": %zu, "
+				"\"median_ns\": %.3f, \"min_ns\": %.3f", i ? "," : "",
+				result.name.c_str(), result.size, result.iterations,
+				result.median_ns, result.min_ns);
+			for (const auto& counter : result.counters)
+			{
+				std::fprintf(out, ", \"%s\": %.3f", counter.first.c_str(), counter.second);
+			}
+			std::fprintf(out, "}");
+		}
+		std::fprintf(out, "\n  ]\n}\n");
+		return std::fclose(out) == 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string json_file;
+	std::string filter;
+	double min_seconds = 0.1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+		{
+			json_file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			filter = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+		{
+			min_seconds = std::max(0.001, std::atof(argv[++i]));
+		}
+	}
+
+	std::vector<Benchmark> benchmarks;
+	addMath(benchmarks);
+	addSprites(benchmarks);
+	addCollision(benchmarks);
+	addEntities(benchmarks);
+	addSorting(benchmarks);
+	addPlayback(benchmarks);
+	addBlending(benchmarks);
+	addHud(benchmarks);
+#ifdef PROFILING
+	addProfiler(benchmarks);
+#endif
+	addGame(benchmarks);
+
+	std::vector<Result> results;
+	std::printf("%-38s %8s %12s %14s %14s\n", "benchmark", "size", "iterations", "median ns", "min ns");
+	for (const auto& benchmark : benchmarks)
+	{
+		if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		Result result;
+		if (!measure(benchmark, min_seconds, result))
+		{
+			std::printf("%-38s %8zu  could not run\n", benchmark.name.c_str(), benchmark.size);
+			continue;
+		}
+
+		std::printf("%-38s %8zu %12zu %14.2f %14.2f", result.name.c_str(), result.size,
+			result.iterations, result.median_ns, result.min_ns);
+		for (const auto& counter : result.counters)
+		{
+			std::printf("  %s %.1f", counter.first.c_str(), counter.second);
+		}
+		std::printf("\n");
+		std::fflush(stdout);
+		results.push_back(result);
+	}
+
+	if (!json_file.empty() && !writeJson(json_file, results))
+	{
+		std::fprintf(stderr, "could not write %s\n", json_file.c_str());
+		return 1;
+	}
+
+	return 0;
+}
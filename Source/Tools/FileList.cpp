@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cctype>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "FileList.h"
+
+namespace
+{
+	struct Item
+	{
+		std::string name;
+		bool is_directory = false;
+	};
+
+	std::vector<Item> readDirectory(const std::string& directory)
+	{
+		std::vector<Item> items;
+
+#ifdef _WIN32
+		WIN32_FIND_DATAA found;
+		auto handle = FindFirstFileA((directory + "\\*").c_str(), &found);
+		if (handle != INVALID_HANDLE_VALUE)
+		{
+			do
+			{
+				Item item;
+				item.name = found.cFileName;
+				item.is_directory = (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+				items.push_back(item);
+			} while (FindNextFileA(handle, &found));
+			FindClose(handle);
+		}
+#else
+		if (auto dir = opendir(directory.c_str()))
+		{
+			while (auto entry = readdir(dir))
+			{
+				Item item;
+				item.name = entry->d_name;
+
+				struct stat info;
+				item.is_directory = stat((directory + "/" + item.name).c_str(), &info) == 0 &&
+					S_ISDIR(info.st_mode);
+				items.push_back(item);
+			}
+			closedir(dir);
+		}
+#endif
+
+		return items;
+	}
+
+	bool hasExtension(const std::string& file_name, const std::string& extension)
+	{
+		if (file_name.size() < extension.size())
+		{
+			return false;
+		}
+
+		return std::equal(extension.begin(), extension.end(),
+			file_name.end() - extension.size(), [](char a, char b)
+		{
+			return std::tolower(static_cast<unsigned char>(a)) ==
+				std::tolower(static_cast<unsigned char>(b));
+		});
+	}
+
+	void search(const std::string& directory, const std::string& prefix,
+		const std::string& extension, bool recursive, std::vector<std::string>& files)
+	{
+		for (const auto& item : readDirectory(directory))
+		{
+			if (item.name == "." || item.name == "..")
+			{
+				continue;
+			}
+
+			if (item.is_directory)
+			{
+				if (recursive)
+				{
+					search(directory + "/" + item.name, prefix + item.name + "/",
+						extension, recursive, files);
+				}
+			}
+			else if (hasExtension(item.name, extension))
+			{
+				files.push_back(prefix + item.name);
+			}
+		}
+	}
+}
+
+std::vector<std::string> listFiles(
+	const std::string& directory, const std::string& extension, bool recursive)
+{
+	std::vector<std::string> files;
+	search(directory, "", extension, recursive, files);
+	std::sort(files.begin(), files.end());
+	return files;
+}
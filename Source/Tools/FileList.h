@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+*  Lists the files in a folder with a given extension.
+*  Shared by the asset tools. Paths are returned relative to the
+*  folder, use forward slashes and are sorted, so tools produce the
+*  same output regardless of the order the file system reports.
+*  @param [in] directory The folder to search.
+*  @param [in] extension The extension to match, such as ".png". Case insensitive.
+*  @param [in] recursive Whether to search sub folders too.
+*  @return the matching files.
+*/
+std::vector<std::string> listFiles(
+	const std::string& directory, const std::string& extension, bool recursive);
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+*  Three copies of a value, passed from one writing thread to one
+*  reading thread without locks.
+*  The writer fills its buffer and publishes it, and the reader picks
+*  up the latest published buffer. Neither waits for the other: the
+*  writer always has a buffer to fill, and the reader keeps its
+*  current buffer until a newer one is published. Buffers are reused,
+*  so their storage is kept between frames.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+
+	/**
+	*  Returns the buffer the writer fills.
+	*  @return the writer's buffer.
+	*/
+	T& writeBuffer()
+	{
+		return buffers[write_index];
+	}
+
+	/**
+	*  Hands the writer's buffer to the reader.
+	*  The writer is given the buffer the reader is not using.
+	*/
+	void publish()
+	{
+		write_index = middle.exchange(write_index | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	/**
+	*  Picks up the latest published buffer, if there is one.
+	*  @return true if the read buffer changed.
+	*/
+	bool acquire()
+	{
+		if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+		{
+			return false;
+		}
+
+		read_index = middle.exchange(read_index, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	/**
+	*  Returns the buffer the reader holds.
+	*  @return the reader's buffer.
+	*/
+	const T& readBuffer() const
+	{
+		return buffers[read_index];
+	}
+
+private:
+	static const uint8_t INDEX = 0x03;
+	static const uint8_t FRESH = 0x04;
+
+	T buffers[3];
+	std::atomic<uint8_t> middle{ 1 };
+	uint8_t write_index = 0;
+	uint8_t read_index = 2;
+};
@@ -1,7 +1,363 @@
+#ifdef HEADLESS
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <Engine/Keys.h>
+#include "Game.h"
+#include "Profiler.h"
+
+namespace
+{
+	/**
+	*   @brief   Checks fast-forwarding against ticking.
+	*   @details Both games must be loaded, from the same seed, and
+				 still in the menu. One ticks through the time a tick
+				 per frame and the other fast-forwards it. Nothing
+				 touches the paddle. The time should end before the
+				 game is over, as fast-forwarding stops there while
+				 ticking carries on, and before a gem can reach the
+				 paddle, as gems stand still while fast-forwarding.
+				 Ball positions may differ by rounding, as the ticks
+				 sweep a tick's move at a time.
+	*   @return  True if both ended the same.
+	*/
+	bool checkFastForward(BreakoutGame& ticked, BreakoutGame& forwarded, double seconds, double tick_ms)
+	{
+		const float TOLERANCE = 0.05f;
+		auto tick_count = static_cast<int>(std::lround(seconds * 1000 / tick_ms));
+
+		ticked.tapKey(ASGE::KEYS::KEY_ENTER);
+		ticked.runFrames(tick_count, tick_ms);
+		auto expected = ticked.status();
+
+		auto impacts = forwarded.fastForward(tick_count * tick_ms / 1000);
+		auto actual = forwarded.status();
+
+		std::printf("ticked %lld ticks, fast-forwarded through %zu impacts\n", expected.ticks, impacts);
+		std::printf("%-15s %12s %12s\n", "", "ticked", "forwarded");
+		std::printf("%-15s %12d %12d\n", "score", expected.score, actual.score);
+		std::printf("%-15s %12d %12d\n", "lives", expected.lives, actual.lives);
+		std::printf("%-15s %12d %12d\n", "bricks left", expected.bricks_left, actual.bricks_left);
+		std::printf("%-15s %12.3f %12.3f\n", "ball x", expected.ball.x, actual.ball.x);
+		std::printf("%-15s %12.3f %12.3f\n", "ball y", expected.ball.y, actual.ball.y);
+		std::printf("%-15s %12.3f %12.3f\n", "paddle x", expected.paddle.x, actual.paddle.x);
+
+		return expected.ticks == actual.ticks &&
+			expected.score == actual.score &&
+			expected.lives == actual.lives &&
+			expected.bricks_left == actual.bricks_left &&
+			std::abs(expected.ball.x - actual.ball.x) <= TOLERANCE &&
+			std::abs(expected.ball.y - actual.ball.y) <= TOLERANCE &&
+			std::abs(expected.paddle.x - actual.paddle.x) <= TOLERANCE;
+	}
+}
+
+/**
+*   @brief   Runs the game without a window.
+*   @details Usage:
+			 BreakoutHeadless [frames] [--software [WxH]] [--save file.png]
+			                  [--pipelined | --serial] [--tick-rate hz]
+			                  [--seed n] [--record file | --replay file]
+			                  [--jobs n] [--trace file.json] [--stats]
+			                  [--scene layout:bricks[:balls[:gems[:falling]]]]
+			                  [--fast-forward s | --check-fast-forward s]
+			 Loading is completed up front and Enter is pressed to
+			 leave the menu, then the game runs at a fixed 60Hz step
+			 as fast as it can. --tick-rate sets how often the game
+			 simulates within those frames, 60Hz by default.
+			 --seed fixes the game's random numbers, --record writes
+			 the session to a replay file, and --replay runs one back
+			 as fast as possible without drawing, checking it plays
+			 out as recorded. Returns 2 if it did not. --jobs sets
+			 the threads that share each tick's jobs. --trace writes
+			 the profiler's zones as a Chrome trace, in builds with
+			 PROFILING defined. --stats prints how long the game took
+			 to start, the key events dropped and the times of the
+			 last frames run.
+			 --software draws with the software renderer, optionally
+			 at another resolution, and --save writes its last frame. --pipelined and --serial choose whether
+			 frames are simulated on their own thread, which
+			 otherwise depends on the number of hardware threads.
+			 --scene builds a stress scene in rows, dense or sparse
+			 layouts. It is saved with a recording, and a replay is
+			 played in the scene it was recorded in. --fast-forward skips that many seconds
+			 of play with the event driven simulation before the
+			 frames are run. --check-fast-forward plays that long
+			 both ways, ticking and fast-forwarding, with no input
+			 after leaving the menu, and returns 2 if they ended
+			 differently.
+*   @return  0 on success.
+*/
+int main(int argc, char* argv[])
+{
+	int frame_count = 10000;
+	bool software = false;
+	int output_width = 0, output_height = 0;
+	std::string save_file;
+	int pipelined = -1;
+	double tick_rate = 0;
+	bool seeded = false;
+	uint32_t seed = 0;
+	std::string record_file;
+	std::string replay_file;
+	int job_threads = -1;
+	std::string trace_file;
+	bool print_stats = false;
+	SceneSettings scene;
+	double fast_forward = 0;
+	double check_fast_forward = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--software") == 0)
+		{
+			software = true;
+			if (i + 1 < argc && std::sscanf(argv[i + 1], "%dx%d", &output_width, &output_height) == 2)
+			{
+				i++;
+			}
+		}
+		else if (std::strcmp(argv[i], "--save") == 0 && i + 1 < argc)
+		{
+			save_file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--pipelined") == 0 || std::strcmp(argv[i], "--serial") == 0)
+		{
+			pipelined = std::strcmp(argv[i], "--pipelined") == 0;
+		}
+		else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+		{
+			tick_rate = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seeded = true;
+			seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			record_file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replay_file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			trace_file = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--stats") == 0)
+		{
+			print_stats = true;
+		}
+		else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			job_threads = std::max(0, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--fast-forward") == 0 && i + 1 < argc)
+		{
+			fast_forward = std::max(0.0, std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--check-fast-forward") == 0 && i + 1 < argc)
+		{
+			check_fast_forward = std::max(0.0, std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+		{
+			if (!scene.parse(argv[++i]))
+			{
+				std::fprintf(stderr, "could not read scene %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else
+		{
+			frame_count = std::atoi(argv[i]);
+		}
+	}
+
+	Replay session;
+	if (!replay_file.empty())
+	{
+		if (!session.load(replay_file))
+		{
+			std::fprintf(stderr, "could not read %s\n", replay_file.c_str());
+			return 1;
+		}
+		seeded = true;
+		seed = session.seed();
+		scene = session.scene();
+	}
+
+	if (check_fast_forward > 0 && !seeded)
+	{
+		// both games must start from the same seed
+		seeded = true;
+		seed = static_cast<uint32_t>(std::time(nullptr));
+	}
+
+	// makes a game with the chosen settings, loaded and in the menu
+	auto makeGame = [&]() -> BreakoutGame*
+	{
+		BreakoutGame* game = new BreakoutGame;
+		if (seeded)
+		{
+			game->setSeed(seed);
+		}
+
+		if (!record_file.empty())
+		{
+			game->startRecording();
+		}
+
+		game->setScene(scene);
+
+		if (job_threads >= 0)
+		{
+			game->setJobThreads(static_cast<unsigned>(job_threads));
+		}
+
+		if (software)
+		{
+			game->useBackend(HeadlessGame::Backend::SOFTWARE, output_width, output_height);
+		}
+
+		if (pipelined >= 0)
+		{
+			game->setPipelined(pipelined != 0);
+		}
+
+		if (tick_rate > 0)
+		{
+			game->setTickRate(tick_rate);
+		}
+
+		if (!game->init() || !game->finishLoading())
+		{
+			delete game;
+			return nullptr;
+		}
+		return game;
+	};
+
+	PROFILE_THREAD("main");
+	BreakoutGame* game = makeGame();
+	if (!game)
+	{
+		return 1;
+	}
+
+	if (check_fast_forward > 0)
+	{
+		BreakoutGame* forwarded = makeGame();
+		if (!forwarded)
+		{
+			delete game;
+			return 1;
+		}
+
+		auto tick_ms = 1000.0 / (tick_rate > 0 ? tick_rate : 60.0);
+		bool same = checkFastForward(*game, *forwarded, check_fast_forward, tick_ms);
+		std::printf(same ? "fast-forwarding matches ticking\n" :
+			"fast-forwarding differs from ticking\n");
+
+		delete forwarded;
+		delete game;
+		return same ? 0 : 2;
+	}
+
+	if (!replay_file.empty())
+	{
+		auto start = std::chrono::steady_clock::now();
+		auto mismatch = game->replay(session);
+		double seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+
+		std::printf("replayed %zu ticks (%.1fs of play) in %.3fs\n", session.tickCount(),
+			session.tickCount() * session.tickMs() / 1000.0, seconds);
+		if (mismatch >= 0)
+		{
+			std::printf("state differs from the recording from tick %lld\n", mismatch);
+		}
+
+		delete game;
+		return mismatch >= 0 ? 2 : 0;
+	}
+
+	game->tapKey(ASGE::KEYS::KEY_ENTER);
+
+	if (fast_forward > 0)
+	{
+		auto forward_start = std::chrono::steady_clock::now();
+		auto impacts = game->fastForward(fast_forward);
+		double forward_seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - forward_start).count();
+		std::printf("fast-forwarded %.1fs of play through %zu impacts in %.3fs\n",
+			fast_forward, impacts, forward_seconds);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	int frames = game->runFrames(frame_count, 1000.0 / 60.0);
+	double seconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+
+	const auto& stats = game->stats();
+	double per_frame = frames > 0 ? 1.0 / frames : 0;
+	std::printf("%d frames in %.3fs (%.0f fps)\n", frames, seconds,
+		seconds > 0 ? frames / seconds : 0);
+	std::printf("per frame: %.2f draw calls, %.2f sprites, %.2f text calls\n",
+		stats.draw_calls * per_frame, stats.sprites * per_frame,
+		stats.text_calls * per_frame);
+
+	if (print_stats)
+	{
+		double init_ms = 0, ready_ms = 0;
+		game->startupTimes(init_ms, ready_ms);
+		std::printf("startup: init returned after %.1fms, assets ready after %.1fms\n",
+			init_ms, ready_ms);
+		std::printf("input: %llu key events dropped\n",
+			static_cast<unsigned long long>(game->droppedKeys()));
+		game->frameStats().print(stdout);
+	}
+
+	auto frame = game->softwareRenderer();
+	if (frame && !save_file.empty() && !frame->saveFrame(save_file))
+	{
+		std::fprintf(stderr, "could not write %s\n", save_file.c_str());
+	}
+
+	if (!record_file.empty() && !game->saveRecording(record_file))
+	{
+		std::fprintf(stderr, "could not write %s\n", record_file.c_str());
+	}
+
+	delete game;
+	game = nullptr;
+
+	if (!trace_file.empty())
+	{
+#ifndef PROFILING
+		std::fprintf(stderr, "built without PROFILING, the trace will be empty\n");
+#endif
+		if (!Profiler::writeChromeTrace(trace_file))
+		{
+			std::fprintf(stderr, "could not write %s\n", trace_file.c_str());
+		}
+	}
+	return 0;
+}
+#else
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <Engine/Platform.h>
 #include "Game.h"
+#include "Profiler.h"
 
 int WINAPI WinMain(
 	HINSTANCE hInstance, 
@@ -16,4 +372,9 @@ int WINAPI WinMain(
 
 	delete game;
 	game = nullptr;
-}
\ No newline at end of file
+
+#ifdef PROFILING
+	Profiler::writeChromeTrace("trace.json");
+#endif
+}
+#endif